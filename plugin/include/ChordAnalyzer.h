@@ -3,6 +3,8 @@
 #include <vector>
 #include <array>
 #include <cstring>
+#include <cstdint>
+#include "PitchClassSet.h"
 
 /**
  * @brief Chord quality enumeration for analyzer results
@@ -73,6 +75,18 @@ struct ChordInfo {
                   function(ChordFunction::Extended), confidence(0.0f) {}
 };
 
+/**
+ * @brief Allocation-free result of a chord table lookup
+ *
+ * Root is a pitch-class offset relative to pitch class 0 of the looked-up set
+ * (the bass note when the set comes from analyzeChord).
+ */
+struct ChordMatch {
+    ChordQuality quality;                  // Best matching quality (Unknown if none)
+    int rootOffset;                        // Root pitch class relative to the set (0-11)
+    float confidence;                      // 0.0 (no match) to 1.0
+};
+
 /**
  * @class ChordAnalyzer
  * @brief Analyzes chord quality from collections of MIDI notes
@@ -101,7 +115,9 @@ public:
      * @brief Analyze a single interpretation of a chord
      * 
      * Takes a collection of MIDI notes and finds the best matching
-     * chord quality and root position. Returns most likely interpretation.
+     * chord quality and root position. Every chord tone is tried as the
+     * root (so inversions are recognized), ties going to the bass note.
+     * Returns most likely interpretation.
      * 
      * @param notes MIDI note numbers (0-127)
      * @param baseKey Reference key for context (0-11, where 0=C)
@@ -132,6 +148,39 @@ public:
     std::vector<ChordInfo> analyzeChordAmbiguous(
         const std::vector<int>& notes, int baseKey) const;
 
+    /**
+     * @brief Best chord interpretation of a pitch-class set (one table lookup)
+     *
+     * @param pitchClasses Pitch classes, normally relative to the bass note
+     * @return Quality, root offset and confidence over all rotations
+     */
+    static ChordMatch matchPitchClasses(scalechord::PitchClassSet pitchClasses);
+
+    /**
+     * @brief Chord quality with pitch class 0 taken as the root (one table lookup)
+     *
+     * @param pitchClasses Pitch classes relative to the candidate root
+     * @return Quality and confidence with rootOffset = 0
+     */
+    static ChordMatch matchRootPosition(scalechord::PitchClassSet pitchClasses);
+
+    /**
+     * @brief Pitch classes of a chord quality built on pitch class 0
+     *
+     * @param quality Chord quality
+     * @return Interval set of the quality's pattern (empty for Unknown)
+     */
+    static constexpr scalechord::PitchClassSet qualityPitchClasses(ChordQuality quality) noexcept
+    {
+        scalechord::PitchClassSet set;
+        for (const ChordPattern& pattern : CHORD_PATTERNS) {
+            if (pattern.quality != quality) continue;
+            for (int i = 0; i < pattern.numNotes; ++i) set.insert(pattern.intervals[i]);
+            break;
+        }
+        return set;
+    }
+
     /**
      * @brief Detect functional harmony role in a given key
      * 
@@ -252,21 +301,47 @@ private:
     }};
 
     /**
-     * @brief Normalize notes to pitch classes (0-11 range)
+     * @brief Normalize notes to a pitch-class set relative to a key
      * @param notes Input MIDI notes
-     * @param baseKey Reference key
-     * @return Vector of pitch classes (0-11), sorted and deduplicated
+     * @param baseKey Reference key (becomes pitch class 0)
+     * @return Bitmask of pitch classes (0-11)
      */
-    std::vector<int> normalizePitchClasses(
+    scalechord::PitchClassSet normalizePitchClasses(
         const std::vector<int>& notes, int baseKey) const;
 
     /**
-     * @brief Check if normalized pitch class pattern matches chord pattern
+     * @brief Check if normalized pitch class set matches chord pattern
+     *
+     * The pattern matches when the set's pitch classes up to the pattern's
+     * highest interval are exactly the pattern; anything above it counts
+     * as an extension.
+     *
      * @param normalized Normalized pitch classes from normalizePitchClasses
      * @param pattern Chord pattern to test
      * @return Match score (0.0 = no match, 1.0 = perfect match)
      */
-    float matchPatternScore(
-        const std::vector<int>& normalized,
-        const ChordPattern& pattern) const;
+    static float matchPatternScore(
+        scalechord::PitchClassSet normalized,
+        const ChordPattern& pattern);
+
+    /**
+     * @brief Precomputed matches for one 12-bit pitch-class mask
+     */
+    struct ChordTableEntry {
+        ChordQuality rootQuality;       // Pitch class 0 as root
+        float rootConfidence;
+        ChordQuality bestQuality;       // Best over every chord tone as root
+        float bestConfidence;
+        uint8_t bestRoot;               // Pitch class of that root
+    };
+
+    /**
+     * @brief Fills the 4096-entry table of pattern matches
+     */
+    static std::array<ChordTableEntry, 4096> buildChordTable();
+
+    /**
+     * @brief The pattern-match table, built during static initialization
+     */
+    static const std::array<ChordTableEntry, 4096> chordTable_;
 };
@@ -1,8 +1,10 @@
 // Chord voicer - generate chord notes (MIDI) from a root and scale
 #pragma once
 
+#include <array>
 #include <vector>
 #include "ScaleMapper.h"
+#include "SnapshotPublisher.h"
 
 namespace scalechord {
 
@@ -17,6 +19,46 @@ struct VoicerSettings {
     int octaveOffset = 0; // how to shift generated chord
 };
 
+// Small inline-capacity chord buffer - never allocates, safe on the audio thread.
+// push_back() beyond Capacity is ignored and returns false.
+template <int Capacity>
+class FixedChord {
+public:
+    static constexpr int capacity() noexcept { return Capacity; }
+
+    void clear() noexcept { size_ = 0; }
+    bool push_back(int note) noexcept {
+        if (size_ >= Capacity) return false;
+        notes_[size_++] = note;
+        return true;
+    }
+    void pop_back() noexcept { if (size_ > 0) --size_; }
+
+    int size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    int& operator[](int i) noexcept { return notes_[i]; }
+    int operator[](int i) const noexcept { return notes_[i]; }
+
+    int* begin() noexcept { return notes_.data(); }
+    int* end() noexcept { return notes_.data() + size_; }
+    const int* begin() const noexcept { return notes_.data(); }
+    const int* end() const noexcept { return notes_.data() + size_; }
+
+    // Copy out for APIs that still take std::vector (allocates)
+    std::vector<int> toVector() const { return std::vector<int>(begin(), end()); }
+
+private:
+    std::array<int, Capacity> notes_{};
+    int size_ = 0;
+};
+
+using ChordBuffer = FixedChord<8>;
+
+// Thread safety: setSettings()/buildChordCache() run on the message thread; they
+// build an immutable voicing snapshot there and publish it with an atomic swap.
+// makeChordInto()/getCachedChord() are safe on the audio thread: they never
+// allocate, lock or free, and old snapshots are deleted by the next writer call.
 class ChordVoicer {
 public:
     explicit ChordVoicer(const ScaleMapper& mapper);
@@ -28,9 +70,33 @@ public:
     // representing the chord voicing (sorted low->high).
     std::vector<int> makeChordFromNote(int baseMappedMidiNote) const;
 
+    // Allocation-free version of makeChordFromNote(): clears `out` and writes the
+    // voicing into it (sorted low->high). Use this on the audio thread.
+    void makeChordInto(int baseMappedMidiNote, ChordBuffer& out) const;
+
+    // Cached voicing for a mapped note (0-127). All 128 voicings for the mapper's
+    // scale/root and the voicer settings are precomputed in the published snapshot,
+    // so this is a single indexed load. If the mapper settings changed since the
+    // last buildChordCache(), the voicing is computed directly instead.
+    ChordBuffer getCachedChord(int baseMappedMidiNote) const;
+
+    // Rebuild and publish the voicing snapshot (message thread). Call after
+    // changing the mapper's settings.
+    void buildChordCache();
+
 private:
+    struct VoicingSnapshot {
+        VoicerSettings settings;
+        const ScaleTable* table;                // mapper table the chords were built for
+        std::array<ChordBuffer, 128> chords;
+    };
+
+    static void voiceChord(const ScaleTable& table, const VoicerSettings& settings,
+                           int baseMappedMidiNote, ChordBuffer& out);
+
     const ScaleMapper& mapper_;
-    VoicerSettings settings_;
+    VoicerSettings settings_;                    // writer-side copy
+    SnapshotPublisher<VoicingSnapshot> snapshot_;
 };
 
 } // namespace scalechord
@@ -3,6 +3,7 @@
 
 #include <cmath>
 #include <algorithm>
+#include "FastRandom.h"
 
 namespace scalechord {
 
@@ -50,9 +51,13 @@ public:
     
     // Set sample rate for time calculations
     void setSampleRate(float sampleRate) noexcept { sampleRate_ = sampleRate; }
+
+    // Fixed humanization seed (each instance is seeded differently by default)
+    void setSeed(uint64_t seed) noexcept { rng_.seed(seed); }
     
 private:
     EnvelopeSettings settings_;
+    FastRandom rng_;
     EnvelopeState state_ = EnvelopeState::Idle;
     
     float sampleRate_ = 44100.0f;
@@ -69,4 +74,57 @@ private:
     float calculateCurve(float t, float duration, bool exponential = true) const;
 };
 
+// Same ADSR stages as Envelope with exponential (RC-style) segments. Each
+// segment is a one-multiply-one-add recurrence, level = level * coef + offset,
+// whose coefficients are computed in updateIncrements() rather than per sample.
+// Humanization is a per-note attack-time offset drawn at note-on.
+class ExponentialEnvelope {
+public:
+    ExponentialEnvelope() = default;
+    explicit ExponentialEnvelope(const EnvelopeSettings& s);
+
+    void setSettings(const EnvelopeSettings& s);
+    EnvelopeSettings getSettings() const noexcept { return settings_; }
+
+    void noteOn(int velocity = 64, float sampleRate = 44100.0f);
+    void noteOff();
+
+    // One sample; returns amplitude (0.0 - 1.0)
+    float process() noexcept;
+
+    EnvelopeState getState() const noexcept { return state_; }
+    bool isFinished() const noexcept { return state_ == EnvelopeState::Idle; }
+    float getLevel() const noexcept { return level_; }
+
+    void setSampleRate(float sampleRate);
+
+    // Attack-time offset drawn at the last note-on (0 without humanization)
+    float getHumanizeOffset() const noexcept { return humanizeOffset_; }
+
+    void setSeed(uint64_t seed) noexcept { rng_.seed(seed); }
+
+private:
+    // Asymptote overshoot as a fraction of the segment span: the attack
+    // aims 30% past the peak (gentle curve), decay/release 0.01% past the end
+    static constexpr float ATTACK_RATIO = 0.3f;
+    static constexpr float DECAY_RATIO = 0.0001f;
+
+    EnvelopeSettings settings_;
+    FastRandom rng_;
+    EnvelopeState state_ = EnvelopeState::Idle;
+
+    float sampleRate_ = 44100.0f;
+    float level_ = 0.0f;
+    float peak_ = 1.0f;
+    float sustainLevel_ = 0.7f;
+    float humanizeOffset_ = 0.0f;
+
+    float attackCoef_ = 0.0f, attackOffset_ = 0.0f;
+    float decayCoef_ = 0.0f, decayOffset_ = 0.0f;
+    float releaseCoef_ = 0.0f, releaseOffset_ = 0.0f;
+
+    void updateIncrements();
+    float segmentCoef(float ms, float ratio) const;
+};
+
 } // namespace scalechord
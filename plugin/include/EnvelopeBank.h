@@ -0,0 +1,64 @@
+// Block-based ADSR envelopes for all voices at once (SoA, AVX/SSE)
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Envelope.h"
+
+namespace scalechord {
+
+// Same linear ADSR shape as Envelope, one lane per voice. A segment is a level,
+// a per-sample increment and the number of samples left in it, so advancing a
+// voice by n samples is level += min(n, remaining) * increment; stage changes
+// are only handled (scalar) for voices whose segment ends inside the block,
+// never per sample. Sustain and idle have an infinite remaining count.
+class EnvelopeBank {
+public:
+    static constexpr int MAX_VOICES = 64;
+
+    EnvelopeBank();
+    explicit EnvelopeBank(const EnvelopeSettings& s);
+
+    // New settings apply from the next segment each voice enters
+    void setSettings(const EnvelopeSettings& s);
+    EnvelopeSettings getSettings() const noexcept { return settings_; }
+
+    void setSampleRate(float sampleRate) noexcept;
+
+    // Start (or retrigger from its current level) / release one voice
+    void noteOn(int voice, int velocity = 64) noexcept;
+    void noteOff(int voice) noexcept;
+
+    // Advance every voice by numSamples
+    void process(int numSamples) noexcept;
+
+    float getLevel(int voice) const noexcept;
+    EnvelopeState getState(int voice) const noexcept;
+    bool isFinished(int voice) const noexcept { return getState(voice) == EnvelopeState::Idle; }
+
+    // Levels of all MAX_VOICES voices after the last process()
+    const float* getLevels() const noexcept { return level_.data(); }
+    int getActiveCount() const noexcept;
+
+    // Every voice back to idle
+    void reset() noexcept;
+
+private:
+    EnvelopeSettings settings_;
+    float sampleRate_ = 44100.0f;
+
+    // Per-voice segment state (structure of arrays)
+    alignas(32) std::array<float, MAX_VOICES> level_;
+    alignas(32) std::array<float, MAX_VOICES> increment_;
+    alignas(32) std::array<float, MAX_VOICES> remaining_;   // samples left in segment
+    alignas(32) std::array<float, MAX_VOICES> target_;      // level at segment end
+    alignas(32) std::array<float, MAX_VOICES> peak_;        // velocity-scaled attack peak
+    alignas(32) std::array<float, MAX_VOICES> todo_;        // scratch: samples left this block
+    std::array<EnvelopeState, MAX_VOICES> state_;
+
+    float segmentSamples(float ms) const noexcept;
+    void enterStage(int voice, EnvelopeState stage) noexcept;
+    uint64_t advanceLanes() noexcept;   // returns voices whose segment just ended
+};
+
+} // namespace scalechord
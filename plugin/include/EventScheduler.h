@@ -0,0 +1,141 @@
+// Sample-accurate scheduler for MIDI events that fall in future blocks
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace scalechord {
+
+struct ScheduledMidiEvent {
+    int64_t time = 0;               // absolute sample time
+    uint8_t status = 0;             // raw MIDI bytes
+    uint8_t data1 = 0;
+    uint8_t data2 = 0;
+    bool tempoRelative = false;     // scheduled in beats; follows tempo changes
+    uint32_t tag = 0;               // caller's token (e.g. which key press a gate belongs to)
+
+    bool isNoteOff() const noexcept {
+        return (status & 0xF0) == 0x80 || ((status & 0xF0) == 0x90 && data2 == 0);
+    }
+};
+
+// Hierarchical timing wheel keyed on absolute sample time. Level 0 has one slot
+// per sample for the current 1024-sample window; levels 1 and 2 hold coarser
+// 1024- and 2^20-sample slots and are cascaded down as time reaches them.
+// Insert is O(1), a block drain is O(events + blockSize / 64), events come out
+// in time order (FIFO for equal times), and all nodes come from a pool sized at
+// construction, so nothing allocates on the audio thread.
+class EventScheduler {
+public:
+    static constexpr int DEFAULT_CAPACITY = 16384;
+    static constexpr int64_t HORIZON = (int64_t(1) << 30) - (int64_t(1) << 20);  // ~6.7 h at 44.1 kHz
+
+    explicit EventScheduler(int capacity = DEFAULT_CAPACITY);
+
+    // Set rate and tempo without touching pending events (call from prepareToPlay)
+    void prepare(double sampleRate, double bpm);
+
+    // Rescale pending events: a sample-rate change moves all of them, a tempo
+    // change only those scheduled in beats. O(pending events).
+    void setSampleRate(double sampleRate);
+    void setTempo(double bpm);
+
+    double getSampleRate() const noexcept { return sampleRate_; }
+    double getTempo() const noexcept { return bpm_; }
+
+    // Start of the next block to be processed
+    int64_t getCurrentTime() const noexcept { return now_; }
+
+    // Returns false if the pool is full or the time is beyond HORIZON.
+    // Times already in the past are delivered at the start of the next block.
+    // `tag` is handed back untouched with the event.
+    bool scheduleAt(int64_t sampleTime, uint8_t status, uint8_t data1, uint8_t data2,
+                    uint32_t tag = 0) noexcept;
+    bool scheduleAfter(int64_t delaySamples, uint8_t status, uint8_t data1, uint8_t data2,
+                       uint32_t tag = 0) noexcept {
+        return scheduleAt(now_ + delaySamples, status, data1, data2, tag);
+    }
+    bool scheduleAfterBeats(double beats, uint8_t status, uint8_t data1, uint8_t data2,
+                            uint32_t tag = 0) noexcept;
+
+    // Advance by one block, calling fn(const ScheduledMidiEvent&, int sampleOffset)
+    // for every event due in it. fn may schedule more events.
+    template <typename Fn>
+    void processBlock(int numSamples, Fn&& fn) {
+        const int64_t blockStart = now_;
+        const int64_t end = now_ + std::max(0, numSamples);
+        while (now_ < end) {
+            const int64_t windowEnd = std::min(end, (now_ | SLOT_MASK) + 1);
+            int slot;
+            while ((slot = nextOccupied(static_cast<int>(now_ & SLOT_MASK),
+                                        static_cast<int>((windowEnd - 1) & SLOT_MASK))) >= 0) {
+                now_ = (now_ & ~int64_t(SLOT_MASK)) | slot;
+                for (int32_t n = detach(0, slot); n >= 0;) {
+                    const int32_t next = nodes_[n].next;
+                    fn(nodes_[n].event, static_cast<int>(nodes_[n].event.time - blockStart));
+                    release(n);
+                    n = next;
+                }
+            }
+            now_ = windowEnd;
+            if ((now_ & SLOT_MASK) == 0) cascade();
+        }
+    }
+
+    // Transport stop: pending note-offs are delivered now (fn(event, 0)) so
+    // nothing hangs; everything else is dropped
+    template <typename Fn>
+    void flush(Fn&& fn) {
+        for (int level = 0; level < LEVELS; ++level) {
+            for (int slot = 0; slot < WHEEL_SIZE; ++slot) {
+                for (int32_t n = detach(level, slot); n >= 0;) {
+                    const int32_t next = nodes_[n].next;
+                    if (nodes_[n].event.isNoteOff()) fn(nodes_[n].event, 0);
+                    release(n);
+                    n = next;
+                }
+            }
+        }
+    }
+
+    // Drop everything and restart at sample 0
+    void clear() noexcept;
+
+    int getPendingCount() const noexcept { return pending_; }
+    int getCapacity() const noexcept { return static_cast<int>(nodes_.size()); }
+
+private:
+    static constexpr int LEVELS = 3;
+    static constexpr int WHEEL_BITS = 10;
+    static constexpr int WHEEL_SIZE = 1 << WHEEL_BITS;
+    static constexpr int SLOT_MASK = WHEEL_SIZE - 1;
+
+    struct Node {
+        ScheduledMidiEvent event;
+        int32_t next = -1;
+    };
+
+    std::vector<Node> nodes_;
+    int32_t freeList_ = -1;
+    int pending_ = 0;
+
+    std::array<std::array<int32_t, WHEEL_SIZE>, LEVELS> heads_;
+    std::array<std::array<int32_t, WHEEL_SIZE>, LEVELS> tails_;
+    std::array<uint64_t, WHEEL_SIZE / 64> occupied_{};    // level-0 slots with events
+
+    int64_t now_ = 0;
+    double sampleRate_ = 44100.0;
+    double bpm_ = 120.0;
+
+    bool schedule(const ScheduledMidiEvent& e) noexcept;
+    void insert(int32_t node) noexcept;
+    int32_t detach(int level, int slot) noexcept;       // whole slot list, FIFO order
+    void release(int32_t node) noexcept;
+    void cascade() noexcept;
+    void rescale(double ratio, bool tempoRelativeOnly) noexcept;
+    int nextOccupied(int from, int to) const noexcept;  // first level-0 slot in [from, to], -1 if none
+};
+
+} // namespace scalechord
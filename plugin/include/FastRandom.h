@@ -0,0 +1,73 @@
+// Small per-instance PRNG (xoshiro128++) for effects that need randomness
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace scalechord {
+
+// 16 bytes of state, a few cycles per number, no locks. Each effect object
+// owns one, so instances and threads never share state, and a fixed seed
+// makes offline renders bit-reproducible. Satisfies UniformRandomBitGenerator
+// (usable with std::shuffle).
+class FastRandom {
+public:
+    using result_type = uint32_t;
+
+    // Distinct seed for every call (time + process-wide counter)
+    static uint64_t makeSeed() noexcept {
+        static std::atomic<uint64_t> counter{0};
+        const uint64_t time = static_cast<uint64_t>(
+            std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        return time ^ (counter.fetch_add(1, std::memory_order_relaxed) * 0x9E3779B97F4A7C15ull);
+    }
+
+    FastRandom() noexcept { seed(makeSeed()); }
+    explicit FastRandom(uint64_t s) noexcept { seed(s); }
+
+    // Any 64-bit value, including 0, gives a valid state (expanded with splitmix64)
+    void seed(uint64_t s) noexcept {
+        for (uint32_t& word : state_) {
+            s += 0x9E3779B97F4A7C15ull;
+            uint64_t z = s;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+        }
+    }
+
+    uint32_t next() noexcept {
+        const uint32_t result = rotl(state_[0] + state_[3], 7) + state_[0];
+        const uint32_t t = state_[1] << 9;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 11);
+        return result;
+    }
+
+    // [0, 1) from the top 24 bits
+    float nextFloat() noexcept { return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f); }
+
+    // [-1, 1)
+    float nextBipolar() noexcept { return nextFloat() * 2.0f - 1.0f; }
+
+    // Batch of `count` uniforms in [0, 1)
+    void fillUniform(float* out, int count) noexcept {
+        for (int i = 0; i < count; ++i) out[i] = nextFloat();
+    }
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return UINT32_MAX; }
+    result_type operator()() noexcept { return next(); }
+
+private:
+    uint32_t state_[4] = {};
+
+    static uint32_t rotl(uint32_t x, int k) noexcept { return (x << k) | (x >> (32 - k)); }
+};
+
+} // namespace scalechord
@@ -0,0 +1,72 @@
+// Groove templates: per-16th timing offsets and velocity scales
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace scalechord {
+
+struct GrooveNote {
+    double ppq = 0.0;       // position in quarter notes
+    int velocity = 100;
+};
+
+// One cycle of `length` 16th steps, each with a timing offset (in 16ths,
+// positive = late) and a velocity scale. Applying a groove is a table lookup
+// by the nearest 16th to the host PPQ position, so it is deterministic and O(1)
+// per event. Templates are extracted from a performance (e.g. a reference MIDI
+// file) or stored in a compact binary form.
+class GrooveTemplate {
+public:
+    static constexpr int MAX_STEPS = 64;        // four bars of 16ths
+    static constexpr double STEP_QN = 0.25;     // a 16th in quarter notes
+
+    explicit GrooveTemplate(int length = 16);
+
+    int getLength() const noexcept { return length_; }
+    float getTimingOffset(int step) const noexcept { return timing_[wrap(step)]; }
+    float getVelocityScale(int step) const noexcept { return velocity_[wrap(step)]; }
+    void setStep(int step, float timingOffset, float velocityScale) noexcept;
+
+    // Cycle step whose grid line is nearest to ppq
+    int stepAt(double ppq) const noexcept { return wrap(gridIndex(ppq)); }
+
+    // Groove offset in quarter notes for an event at ppq
+    double timingOffsetQn(double ppq) const noexcept { return timing_[stepAt(ppq)] * STEP_QN; }
+
+    int applyVelocity(int velocity, double ppq, float amount = 1.0f) const noexcept;
+
+    // "Tighten to groove": move ppq toward its step's groove position by
+    // strength (0-1), at most maxShiftQn either way. Real-time callers must run
+    // maxShiftQn of lookahead (delay input by it) for notes to move earlier.
+    double tighten(double ppq, float strength, double maxShiftQn) const noexcept;
+
+    // Average timing offset and velocity per step over a performance
+    static bool extract(const std::vector<GrooveNote>& notes, int length, GrooveTemplate& outGroove);
+
+    // Note-ons from every track of a Standard MIDI File (PPQ timebase only)
+    static bool parseMidiFile(const std::string& bytes, std::vector<GrooveNote>& outNotes);
+    bool loadFromMidiFile(const std::string& filepath, int length = 16);
+
+    // Compact binary form: "GRV1", length, then per step an int8 timing offset
+    // (1/254 of a 16th) and a uint8 velocity scale (percent)
+    std::string toBinary() const;
+    static bool fromBinary(const std::string& bytes, GrooveTemplate& outGroove);
+    bool load(const std::string& filepath);
+    bool save(const std::string& filepath) const;
+
+private:
+    std::array<float, MAX_STEPS> timing_{};
+    std::array<float, MAX_STEPS> velocity_;
+    int length_ = 16;
+
+    static int64_t gridIndex(double ppq) noexcept;
+    int wrap(int64_t step) const noexcept {
+        int s = static_cast<int>(step % length_);
+        return s < 0 ? s + length_ : s;
+    }
+};
+
+} // namespace scalechord
@@ -2,8 +2,21 @@
 
 #include <vector>
 #include <array>
+#include <cstddef>
 #include "ChordAnalyzer.h"
 
+/**
+ * @brief Family a substitution belongs to
+ */
+enum class SubstitutionKind {
+    Extension,          // same root, richer quality (Maj7, m9, 13...)
+    Tritone,            // dominant a tritone away (bII7 for V7)
+    SecondaryDominant,  // chord made dominant, resolving a fifth down (VI7 = V7/ii)
+    UpperStructure,     // major triad over a dominant (rootOffset = triad root)
+    Backdoor,           // bVII7 / iv m7 approach to the tonic
+    ModalInterchange,   // borrowed from the parallel major/minor
+};
+
 /**
  * @brief Jazz chord substitution suggestion
  * 
@@ -20,6 +33,24 @@ struct Substitution {
     ChordQuality substituteQuality;      // Alternative chord type
     const char* name;                    // Name (e.g., "Tritone Sub", "SecDom")
     float musicality;                    // 0-100, quality of substitution
+    int rootOffset = 0;                  // Substitute root above the degree's root (semitones)
+    SubstitutionKind kind = SubstitutionKind::Extension;
+};
+
+/**
+ * @brief Non-owning view of substitutions in static storage
+ *
+ * Valid for the lifetime of the program; never allocates.
+ */
+struct SubstitutionSpan {
+    const Substitution* first = nullptr;
+    size_t count = 0;
+
+    constexpr const Substitution* begin() const noexcept { return first; }
+    constexpr const Substitution* end() const noexcept { return first + count; }
+    constexpr size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+    constexpr const Substitution& operator[](size_t i) const noexcept { return first[i]; }
 };
 
 /**
@@ -78,9 +109,14 @@ public:
      * - V7#5 (augmented dominant)
      * - V7b9 (dominant with flat 9)
      * 
+     * The whole catalogue (extensions, tritone subs, secondary dominants,
+     * upper structures, backdoor and modal interchange) is built and
+     * sorted at compile time, so this is an index lookup: safe on the
+     * audio thread.
+     * 
      * @param scaleDegree Scale degree (0-6: I, ii, iii, IV, V, vi, vii°)
      * @param majorKey True for major key, false for minor
-     * @return Vector of Substitution options (highest musicality first)
+     * @return View of Substitution options (highest musicality first)
      * 
      * @example
      * @code
@@ -90,8 +126,13 @@ public:
      * }
      * @endcode
      */
-    std::vector<Substitution> getSubstitutions(
-        int scaleDegree, bool majorKey) const;
+    SubstitutionSpan getSubstitutions(
+        int scaleDegree, bool majorKey) const noexcept;
+
+    /**
+     * @brief Every substitution, major key degrees 0-6 then minor 0-6
+     */
+    static SubstitutionSpan getCatalogue() noexcept;
 
     /**
      * @brief Generate tritone substitution for a dominant chord
@@ -0,0 +1,74 @@
+// Streaming key/scale detection from a decayed pitch-class histogram
+#pragma once
+
+#include <array>
+#include "ScaleMapper.h"
+#include "ScaleTables.h"
+
+namespace scalechord {
+
+struct KeyTrackerSettings {
+    float halfLifeNotes = 24.0f;   // a note's weight halves after this many further note-ons
+    float hysteresis = 0.1f;       // a new key must lead the current one by this fraction of histogram weight
+    int holdNotes = 3;             // ...on this many consecutive note-ons before the key changes
+    bool velocityWeighted = true;  // louder notes count more
+};
+
+struct KeyEstimate {
+    ScaleType scale = ScaleType::Ionian;
+    int rootNote = 0;              // 0-11
+    float fit = 0.0f;              // template score per unit of histogram weight (-1 to 2)
+};
+
+// Follows the player's key without rescanning note history. Each note-on
+// adds to an exponentially decayed 12-bin histogram and updates the scores of
+// all 15 x 12 scale templates in one vectorized pass; the reported key only
+// changes once a challenger has led by the hysteresis margin for holdNotes
+// note-ons in a row. No allocation after construction.
+class KeyTracker {
+public:
+    KeyTracker();
+    explicit KeyTracker(const KeyTrackerSettings& s);
+
+    void setSettings(const KeyTrackerSettings& s);
+    KeyTrackerSettings getSettings() const noexcept { return settings_; }
+
+    // Feed a note-on. Returns true when the reported key changed (see getKey()).
+    bool noteOn(int midiNote, int velocity = 100) noexcept;
+
+    // Current key (changes only with hysteresis). C Ionian until enough notes arrive.
+    KeyEstimate getKey() const noexcept { return estimateFor(current_); }
+
+    // Best-scoring key for the histogram right now, ignoring hysteresis
+    KeyEstimate getBestCandidate() const noexcept { return estimateFor(bestKey()); }
+
+    // Decayed weight per pitch class, normalized to sum to 1 (all zero before any note)
+    std::array<float, 12> getHistogram() const noexcept;
+
+    void reset() noexcept;
+
+    static constexpr int NUM_KEYS = NUM_SCALE_TYPES * 12;
+    static constexpr int PADDED_KEYS = (NUM_KEYS + 7) / 8 * 8;  // whole SIMD registers
+
+private:
+    KeyTrackerSettings settings_;
+    float growth_ = 1.0f;          // 1 / per-note decay
+
+    // Instead of decaying every bin on each note, new notes are added with a
+    // weight that grows by 1/decay per note; everything is rescaled before the
+    // weight gets large. Scores are linear in the histogram so they scale along.
+    std::array<float, 12> histogram_{};
+    alignas(32) std::array<float, PADDED_KEYS> scores_{};
+    float weight_ = 1.0f;
+    float mass_ = 0.0f;            // sum of histogram_
+
+    int current_ = 0;              // key index: root * NUM_SCALE_TYPES + scale
+    int challenger_ = -1;
+    int challengerNotes_ = 0;
+
+    int bestKey() const noexcept;
+    KeyEstimate estimateFor(int key) const noexcept;
+    void rescale() noexcept;
+};
+
+} // namespace scalechord
@@ -1,8 +1,12 @@
 // Advanced MIDI effects: Arpeggiator, Humanizer, Probability
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <cstdint>
+#include "FastRandom.h"
+#include "GrooveTemplate.h"
 
 namespace scalechord {
 
@@ -29,11 +33,34 @@ struct ArpeggiatorSettings {
     float tempoHz = 2.0f;  // fallback for Freerun, in Hz (notes per second)
     int octaveRange = 1;   // how many octaves to span
     bool restartOnNewNote = true;
-    float swing = 0.0f;    // 0.5 = 50% swing
+    float swing = 0.0f;    // 0 = straight, 1 = triplet feel (off-beat steps up to 1/3 step late)
+    float gate = 0.8f;     // note length as a fraction of a step (processBlock)
 };
 
+// Host transport at the first sample of a block
+struct PlayheadInfo {
+    double ppqPosition = 0.0;   // position in quarter notes
+    double bpm = 120.0;
+    double sampleRate = 44100.0;
+    bool isPlaying = true;
+};
+
+// Receives sample-accurate arpeggiator output
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+    virtual void noteOn(int note, int velocity, int sampleOffset) = 0;
+    virtual void noteOff(int note, int sampleOffset) = 0;
+};
+
+// The note sequence is compiled into a fixed array whenever the chord or the
+// settings change, so process() only walks a cursor and never allocates.
 class Arpeggiator {
 public:
+    static constexpr int MAX_CHORD_NOTES = 16;   // extra chord notes are ignored
+    static constexpr int MAX_OCTAVES = 4;
+    static constexpr int MAX_PATTERN = MAX_CHORD_NOTES * MAX_OCTAVES * 2;
+
     Arpeggiator() = default;
     explicit Arpeggiator(const ArpeggiatorSettings& s);
     
@@ -43,24 +70,54 @@ public:
     // Update chord notes
     void setChordNotes(const std::vector<int>& notes);
     
+    // Velocity of processBlock() note-ons
+    void setVelocity(int velocity) noexcept { velocity_ = std::max(1, std::min(127, velocity)); }
+
     // Process: returns note that should be played now (or -1 if none)
-    int process(float sampleRate, float tempoHz = 120.0f);
+    int process(float sampleRate, float bpm = 120.0f);
+
+    // Emit every step starting inside the block, with its note-off after `gate`.
+    // Step k starts at k steps from PPQ 0 (plus swing on odd steps), computed
+    // in closed form from the host position: O(steps in the block), and
+    // locked to the DAW across loops and relocation.
+    void processBlock(const PlayheadInfo& playhead, int numSamples, EventSink& sink);
     
     // Reset internal state
     void reset();
     
     // Get current step
     int getCurrentStep() const noexcept { return currentStep_; }
+
+    // Fixed seed for reproducible Random mode (each instance is seeded differently by default)
+    void setSeed(uint64_t seed) noexcept { rng_.seed(seed); }
+
+    // Compiled sequence length (one cycle)
+    int getPatternLength() const noexcept { return patternLength_; }
     
 private:
     ArpeggiatorSettings settings_;
-    std::vector<int> chordNotes_;
+    FastRandom rng_;
+    std::array<int, MAX_CHORD_NOTES> chordNotes_{};   // sorted
+    int numChordNotes_ = 0;
+    std::array<int, MAX_PATTERN> pattern_{};
+    int patternLength_ = 0;
+    int cursor_ = 0;                                  // index into pattern_
     int currentStep_ = 0;
     float phaseFractional_ = 0.0f;  // 0.0 - 1.0
     float notePhase_ = 0.0f;
-    
+
+    // processBlock state
+    int velocity_ = 100;
+    int soundingNote_ = -1;
+    double noteOffPpq_ = 0.0;
+    double expectedPpq_ = -1.0;     // where the next block should start, -1 = unknown
+    int64_t anchorStep_ = 0;        // step that plays pattern index 0
+    bool pendingRestart_ = true;
+    
+    void compilePattern();
     int getNextNote();
-    float getStepDuration(float sampleRate, float tempoHz);
+    double getStepLengthQn(double bpm) const;
+    float getStepDuration(float sampleRate, float bpm);
 };
 
 struct HumanizerSettings {
@@ -68,6 +125,7 @@ struct HumanizerSettings {
     float timingVariation = 0.02f;  // ±2% of note timing
     float velocityVariation = 0.05f;  // ±5% of velocity
     float tuneDeviation = 0.02f;  // ±2 cents
+    float grooveAmount = 1.0f;    // 0-1, how much of the groove template to apply
 };
 
 class Humanizer {
@@ -86,9 +144,27 @@ public:
     
     // Humanize note pitch (returns cents deviation)
     float humanizePitch();
+
+    // Fixed seed for reproducible renders (each instance is seeded differently by default)
+    void setSeed(uint64_t seed) noexcept { rng_.seed(seed); }
+
+    // Groove template: deterministic timing/velocity by host position, applied
+    // on top of (or instead of) the random variation
+    void setGroove(const GrooveTemplate& groove) { groove_ = groove; hasGroove_ = true; }
+    void clearGroove() noexcept { hasGroove_ = false; }
+    bool hasGroove() const noexcept { return hasGroove_; }
+
+    // Groove offset in quarter notes for an event at ppq (0 without a groove)
+    double grooveTimingQn(double ppq) const noexcept;
+
+    // Velocity scaled by the groove step at ppq
+    int grooveVelocity(int velocity, double ppq) const noexcept;
     
 private:
     HumanizerSettings settings_;
+    FastRandom rng_;
+    GrooveTemplate groove_;
+    bool hasGroove_ = false;
 };
 
 struct NoteProbabilitySettings {
@@ -110,9 +186,13 @@ public:
     
     // Reset
     void reset() { currentStep_ = 0; }
+
+    // Fixed seed for reproducible renders (each instance is seeded differently by default)
+    void setSeed(uint64_t seed) noexcept { rng_.seed(seed); }
     
 private:
     NoteProbabilitySettings settings_;
+    FastRandom rng_;
     int currentStep_ = 0;
 };
 
@@ -0,0 +1,124 @@
+// Microtonal scale mapper - Scala (.scl/.kbm) tunings with MPE pitch-bend output
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SnapshotPublisher.h"
+
+namespace scalechord {
+
+// A Scala scale: pitches of degrees 1..N in cents above degree 0.
+// The last entry is the period (usually 1200 = octave).
+struct Tuning {
+    std::string description;
+    std::vector<double> cents;
+
+    // N equal divisions of the period (12 = standard 12-TET)
+    static Tuning equalDivision(int divisions, double periodCents = 1200.0);
+
+    int size() const noexcept { return static_cast<int>(cents.size()); }
+    double periodCents() const noexcept { return cents.empty() ? 1200.0 : cents.back(); }
+
+    // Cents above degree 0 for any integer degree (wraps by the period)
+    double degreeCents(int degree) const noexcept;
+};
+
+// A Scala keyboard mapping (.kbm). Defaults are the linear mapping with
+// degree 0 on middle C and A4 = 440 Hz.
+struct KeyboardMapping {
+    int mapSize = 0;                  // keys per repeat, 0 = linear (one key per degree)
+    int firstNote = 0;                // keys outside [firstNote, lastNote] are unmapped
+    int lastNote = 127;
+    int middleNote = 60;              // key where degree 0 sits
+    int referenceNote = 69;           // key with a known frequency
+    double referenceFrequency = 440.0;
+    int octaveDegree = 0;             // degree of the formal octave, 0 = scale period
+    std::vector<int> mapping;         // degree per key in the pattern, -1 = unmapped ('x')
+};
+
+enum class MicrotonalMode {
+    Quantize,      // snap each incoming 12-TET note to the nearest pitch of the tuning
+    KeyboardMap,   // each key plays a tuning degree as laid out by the .kbm (Scala behaviour)
+};
+
+struct MicrotonalSettings {
+    MicrotonalMode mode = MicrotonalMode::Quantize;
+    float pitchBendRange = 48.0f;     // semitones, MPE default for member channels
+    int firstMemberChannel = 2;       // 1-16; lower MPE zone with master channel 1
+    int numMemberChannels = 15;
+};
+
+// Precomputed output for one incoming key
+struct RetunedNote {
+    int8_t note = -1;                 // output MIDI note, -1 if unmapped / out of range
+    uint16_t pitchBend = 8192;        // 14-bit, 8192 = centre
+};
+
+// A retuned note routed to an MPE member channel
+struct MicrotonalNote {
+    int note = -1;                    // -1 if nothing should be sent
+    int pitchBend = 8192;
+    int channel = -1;                 // 1-16
+};
+
+// Retuning tables are rebuilt on the message thread whenever the tuning,
+// mapping or settings change and published lock-free, so retune() and the
+// MPE noteOn()/noteOff() calls on the audio thread are table lookups with
+// no log2/frequency search and no allocation.
+class MicrotonalMapper {
+public:
+    MicrotonalMapper();   // 12-EDO, linear mapping: every note maps to itself
+
+    void setSettings(const MicrotonalSettings& s);
+    MicrotonalSettings getSettings() const noexcept;
+
+    void setTuning(const Tuning& t);
+    void setKeyboardMapping(const KeyboardMapping& m);
+    Tuning getTuning() const { return tuning_; }
+
+    // Load Scala files. Return false (and leave the current tuning) on error.
+    bool loadScala(const std::string& filepath);
+    bool loadKeyboardMapping(const std::string& filepath);
+    static bool parseScala(const std::string& text, Tuning& outTuning);
+    static bool parseKeyboardMapping(const std::string& text, KeyboardMapping& outMapping);
+
+    // Retuned note and pitch bend for an incoming MIDI note (0-127)
+    RetunedNote retune(int incomingMidiNote) const noexcept;
+
+    // Frequency (Hz) the incoming note sounds at after retuning, 0 if unmapped
+    double getFrequency(int incomingMidiNote) const noexcept;
+
+    // MPE routing (audio thread): give each sounding note its own member channel
+    // so its pitch bend does not affect other notes. Send the pitch bend on the
+    // returned channel before the note-on. Retriggering a held key frees its
+    // previous channel first; `released` receives that note (channel -1 if the
+    // key was not held) so the caller can send its note-off.
+    MicrotonalNote noteOn(int incomingMidiNote, MicrotonalNote* released = nullptr) noexcept;
+    MicrotonalNote noteOff(int incomingMidiNote) noexcept;
+    void reset() noexcept;
+
+private:
+    struct RetuneTable {
+        MicrotonalSettings settings;
+        std::array<RetunedNote, 128> notes;
+        std::array<double, 128> frequencies;
+    };
+
+    // Writer-side state (message thread)
+    MicrotonalSettings settings_;
+    Tuning tuning_;
+    KeyboardMapping mapping_;
+    SnapshotPublisher<RetuneTable> table_;
+
+    // Audio-thread state
+    std::array<MicrotonalNote, 128> held_;        // what each held input note was sent as
+    std::array<uint8_t, 16> notesOnChannel_{};    // held notes per channel (index 0 = channel 1)
+    int nextChannel_ = 0;                         // round-robin start, offset into the member range
+
+    void rebuildTable();
+    double keyCents(int key, bool& mapped) const noexcept;
+};
+
+} // namespace scalechord
@@ -0,0 +1,84 @@
+// MIDI output stage - reference-counted note-on/off per (channel, pitch)
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace scalechord {
+
+struct MidiNoteEvent {
+    enum class Type : uint8_t { NoteOn, NoteOff, None };
+    Type type = Type::None;
+    uint8_t channel = 0;            // 0-15
+    uint8_t note = 0;
+    uint8_t velocity = 0;
+    int samplePosition = 0;
+};
+
+// Sits between the chord generator and the MIDI output. Several held input
+// notes can generate the same output pitch; the stage counts holders per
+// (channel, pitch) and only emits the first note-on and the last note-off, so
+// overlapping chords neither double-trigger nor cut each other off. Within a
+// block, a note-off and note-on for the same pitch at the same sample cancel
+// out (the note just keeps sounding). Fixed capacity, no allocation.
+class MidiOutputStage {
+public:
+    static constexpr int MAX_EVENTS = 1024;   // per block; further events are dropped
+
+    MidiOutputStage();
+
+    // Returns true if this was the first holder (a note-on is queued)
+    bool noteOn(int channel, int note, int velocity, int samplePosition) noexcept;
+
+    // Returns true if this was the last holder (a note-off is queued).
+    // Note-offs for pitches nobody holds are swallowed.
+    bool noteOff(int channel, int note, int samplePosition) noexcept;
+
+    // Turn a pitch off regardless of holders (e.g. its voice was stolen); the
+    // holders' later note-offs are then swallowed. Callers that track holders
+    // must forget the pitch too (NoteTracker::removeOutputNote), or those
+    // note-offs would release a later note-on of the same pitch.
+    void forceNoteOff(int channel, int note, int samplePosition) noexcept;
+
+    // Note-offs for everything sounding
+    void allNotesOff(int samplePosition) noexcept;
+
+    bool isSounding(int channel, int note) const noexcept;
+    int getHolderCount(int channel, int note) const noexcept;
+
+    // Hand queued events to fn(const MidiNoteEvent&) in order and start a new block
+    template <typename Fn>
+    void drainEvents(Fn&& fn) {
+        for (int i = 0; i < numEvents_; ++i) {
+            if (events_[i].type != MidiNoteEvent::Type::None) fn(events_[i]);
+        }
+        numEvents_ = 0;
+        ++block_;
+    }
+
+    int getDroppedEventCount() const noexcept { return droppedEvents_; }
+
+    // Forget all holders and queued events without emitting anything
+    void reset() noexcept;
+
+private:
+    static constexpr int NUM_KEYS = 16 * 128;
+
+    std::array<uint8_t, NUM_KEYS> holders_{};
+    std::array<MidiNoteEvent, MAX_EVENTS> events_;
+    int numEvents_ = 0;
+    int droppedEvents_ = 0;
+
+    // Last queued event per key in the current block (valid when the block matches)
+    std::array<int16_t, NUM_KEYS> lastEvent_{};
+    std::array<uint32_t, NUM_KEYS> lastEventBlock_{};
+    uint32_t block_ = 1;
+
+    static int key(int channel, int note) noexcept { return (channel << 7) | note; }
+    static bool valid(int channel, int note) noexcept {
+        return channel >= 0 && channel < 16 && note >= 0 && note < 128;
+    }
+    void queue(MidiNoteEvent::Type type, int channel, int note, int velocity, int samplePosition) noexcept;
+};
+
+} // namespace scalechord
@@ -0,0 +1,132 @@
+// Envelope-to-MIDI modulation output with change-threshold thinning
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+namespace scalechord {
+
+enum class ModulationTarget {
+    Off,
+    Volume,           // CC7, loudest voice per channel
+    Expression,       // CC11, loudest voice per channel
+    PolyAftertouch,   // per note
+    MpePressure,      // channel pressure on each voice's member channel
+};
+
+struct ModulationSettings {
+    ModulationTarget target = ModulationTarget::Expression;
+    int threshold = 2;              // 7-bit steps that send immediately
+    float minIntervalMs = 5.0f;     // per destination; caps event density
+    float maxIntervalMs = 100.0f;   // smaller changes are sent once this has passed
+};
+
+// Renders per-voice envelope levels (e.g. EnvelopeBank::getLevels()) as MIDI
+// once per block. A destination (a channel for CC7/CC11, a voice otherwise)
+// only sends when its 7-bit value moves by `threshold`, or has changed at all
+// and maxInterval has passed since its last event, and never more often than
+// minInterval. At the defaults a destination sends at most 200 events/s.
+class ModulationOutput {
+public:
+    static constexpr int MAX_VOICES = 64;
+
+    ModulationOutput() { reset(); }
+
+    void setSettings(const ModulationSettings& s) noexcept;
+    ModulationSettings getSettings() const noexcept { return settings_; }
+
+    void setSampleRate(double sampleRate) noexcept;
+
+    // Bind a voice to the note/channel (0-15) it plays; its first value is sent
+    // unthinned. Stop it once its note-off is sent or the voice is stolen, so no
+    // pressure goes out for a note that no longer sounds.
+    void startVoice(int voice, int note, int channel) noexcept;
+    void stopVoice(int voice) noexcept;
+
+    // Advance by a block and call fn(status, data1, data2) for each event to send
+    // (channel pressure has no data2; it is passed as 0)
+    template <typename Fn>
+    void process(const float* levels, int numSamples, Fn&& fn) {
+        if (settings_.target == ModulationTarget::Off) return;
+        const int32_t elapsed = numSamples > 0 ? numSamples : 0;
+
+        if (settings_.target == ModulationTarget::Volume || settings_.target == ModulationTarget::Expression) {
+            // Loudest active voice drives each channel
+            std::array<int, 16> channelValue;
+            channelValue.fill(-1);
+            for (int v = 0; v < MAX_VOICES; ++v) {
+                if (note_[v] < 0) continue;
+                channelValue[channel_[v]] = std::max(channelValue[channel_[v]], quantize(levels[v]));
+            }
+            const uint8_t controller = settings_.target == ModulationTarget::Volume ? 7 : 11;
+            for (int ch = 0; ch < 16; ++ch) {
+                advance(ch, elapsed);
+                if (channelValue[ch] >= 0 && shouldSend(ch, channelValue[ch])) {
+                    fn(static_cast<uint8_t>(0xB0 | ch), controller, static_cast<uint8_t>(channelValue[ch]));
+                }
+            }
+            return;
+        }
+
+        for (int v = 0; v < MAX_VOICES; ++v) {
+            if (note_[v] < 0) continue;
+            const int value = quantize(levels[v]);
+            advance(v, elapsed);
+            if (!shouldSend(v, value)) continue;
+            if (settings_.target == ModulationTarget::PolyAftertouch) {
+                fn(static_cast<uint8_t>(0xA0 | channel_[v]), static_cast<uint8_t>(note_[v]), static_cast<uint8_t>(value));
+            } else {
+                fn(static_cast<uint8_t>(0xD0 | channel_[v]), static_cast<uint8_t>(value), uint8_t(0));
+            }
+        }
+    }
+
+    int getSentCount() const noexcept { return sentCount_; }
+
+    void reset() noexcept;
+
+private:
+    ModulationSettings settings_;
+    double sampleRate_ = 44100.0;
+    int32_t minIntervalSamples_ = 0;
+    int32_t maxIntervalSamples_ = 0;
+
+    std::array<int8_t, MAX_VOICES> note_;        // -1 = voice not bound
+    std::array<uint8_t, MAX_VOICES> channel_;
+
+    // Per destination (channel or voice)
+    std::array<int8_t, MAX_VOICES> lastSent_;    // -1 = nothing sent yet
+    std::array<int32_t, MAX_VOICES> sinceSent_;  // samples since the last event
+
+    int sentCount_ = 0;
+
+    void updateIntervals() noexcept;
+
+    static int quantize(float level) noexcept {
+        const int value = static_cast<int>(std::lround(level * 127.0f));
+        return value < 0 ? 0 : (value > 127 ? 127 : value);
+    }
+
+    void advance(int dest, int32_t elapsed) noexcept {
+        sinceSent_[dest] = std::min(sinceSent_[dest] + elapsed, maxIntervalSamples_);  // saturate
+    }
+
+    bool shouldSend(int dest, int value) noexcept {
+        const int last = lastSent_[dest];
+        if (value == last) return false;
+        const int32_t since = sinceSent_[dest];
+        if (last >= 0) {
+            if (since < minIntervalSamples_) return false;
+            if (std::abs(value - last) < settings_.threshold && since < maxIntervalSamples_) return false;
+        }
+        lastSent_[dest] = static_cast<int8_t>(value);
+        sinceSent_[dest] = 0;
+        ++sentCount_;
+        return true;
+    }
+};
+
+} // namespace scalechord
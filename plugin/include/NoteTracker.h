@@ -1,60 +1,128 @@
 // Advanced note tracking system for polyphonic MIDI handling
 #pragma once
 
+#include <array>
 #include <vector>
-#include <map>
 #include <cstdint>
+#include "ChordVoicer.h"
 
 namespace scalechord {
 
 struct ActiveNote {
     int inputNote;                    // Original MIDI note from user
-    std::vector<int> generatedNotes;  // Chord notes generated for this input
+    ChordBuffer generatedNotes;       // Chord notes generated for this input
     int velocity;                     // Original velocity
     float envelopePhase;              // Envelope position (0.0-1.0)
     bool holdPedalActive = false;     // Whether note is held by sustain pedal
     int samplePosition = 0;           // When the note started
 };
 
+// Set of MIDI notes 0-127 as a 128-bit bitmap; iterates in ascending order
+class OutputNoteSet {
+public:
+    bool contains(int note) const noexcept {
+        return note >= 0 && note < 128 && ((words_[note >> 6] >> (note & 63)) & 1u);
+    }
+    int size() const noexcept;
+    bool empty() const noexcept { return (words_[0] | words_[1]) == 0; }
+
+    void insert(int note) noexcept { words_[note >> 6] |= uint64_t(1) << (note & 63); }
+    void erase(int note) noexcept { words_[note >> 6] &= ~(uint64_t(1) << (note & 63)); }
+    void clear() noexcept { words_ = {}; }
+
+    class Iterator {
+    public:
+        Iterator(const OutputNoteSet& set, int note) noexcept : set_(set), note_(note) { advance(); }
+        int operator*() const noexcept { return note_; }
+        Iterator& operator++() noexcept { ++note_; advance(); return *this; }
+        bool operator!=(const Iterator& o) const noexcept { return note_ != o.note_; }
+    private:
+        void advance() noexcept;
+        const OutputNoteSet& set_;
+        int note_;
+    };
+    Iterator begin() const noexcept { return Iterator(*this, 0); }
+    Iterator end() const noexcept { return Iterator(*this, 128); }
+
+private:
+    std::array<uint64_t, 2> words_{};
+};
+
+// Fixed-capacity tracker: one slot per input note, an intrusive list of the
+// active slots (in trigger order) and a refcount per output note, so note-on/off,
+// sustain release and the active-note queries never allocate on the audio thread.
+// Chords longer than ChordBuffer's capacity are truncated.
 class NoteTracker {
 public:
-    NoteTracker() = default;
-    
-    // Track a new note
-    void trackNoteOn(int inputNote, const std::vector<int>& generatedChord, 
+    NoteTracker();
+
+    // Track a new note (re-triggering an active input note replaces it)
+    void trackNoteOn(int inputNote, const ChordBuffer& generatedChord,
+                     int velocity, int samplePosition = 0);
+    void trackNoteOn(int inputNote, const std::vector<int>& generatedChord,
                      int velocity, int samplePosition = 0);
-    
+
     // Remove a note
     void trackNoteOff(int inputNote, int samplePosition = 0);
-    
+
+    // Drop an output note from every active chord (its voice was stolen), so
+    // the original holders' note-offs cannot release a later note on that pitch
+    void removeOutputNote(int outputNote) noexcept;
+
     // Apply sustain pedal (CC 64)
     void setSustainPedal(bool active) { sustainPedalActive_ = active; }
-    
-    // Get all currently active generated notes
+
+    // Get all currently active generated notes (sorted, unique)
     std::vector<int> getAllActiveGeneratedNotes() const;
-    
+
+    // Same as a bitmap, no allocation
+    const OutputNoteSet& getActiveOutputNotes() const noexcept { return outputNotes_; }
+
+    // How many active input notes are holding an output note
+    int getOutputNoteRefCount(int outputNote) const noexcept;
+
     // Get notes that should be released
     std::vector<int> getNoteOffsForInputNote(int inputNote) const;
-    
+
+    // Generated notes for an active input note, nullptr if not playing (no allocation)
+    const ChordBuffer* getGeneratedNotes(int inputNote) const noexcept;
+
     // Check if input note is currently playing
     bool isNotePlaying(int inputNote) const;
-    
+
     // Get note count
-    int getActiveNoteCount() const noexcept { return activeNotes_.size(); }
-    
+    int getActiveNoteCount() const noexcept { return activeCount_; }
+
     // Clear all notes
     void reset();
-    
+
     // Update envelope phases (call every processing block)
     void updateEnvelopes(float sampleRate);
-    
-    // Get all active notes (for UI/monitoring)
+
+    // Get all active notes in trigger order (for UI/monitoring)
     std::vector<ActiveNote> getActiveNotes() const;
-    
+
 private:
-    std::map<int, ActiveNote> activeNotes_;  // indexed by input MIDI note
+    struct Slot {
+        ActiveNote note;
+        bool active = false;
+        int8_t prev = -1;             // intrusive active list, -1 = none
+        int8_t next = -1;
+    };
+
+    std::array<Slot, 128> slots_;                 // indexed by input MIDI note
+    int8_t head_ = -1;                            // oldest active input note
+    int8_t tail_ = -1;                            // newest active input note
+    int activeCount_ = 0;
+    int sustainedCount_ = 0;                      // released notes held by the pedal
+
+    std::array<uint16_t, 128> outputRefCount_{};  // active input notes per output note
+    OutputNoteSet outputNotes_;                   // outputs with a nonzero refcount
+
     bool sustainPedalActive_ = false;
-    std::vector<int> releasedButSustainedNotes_;  // notes waiting for sustain pedal release
+
+    static bool validNote(int note) noexcept { return note >= 0 && note < 128; }
+    void release(int inputNote) noexcept;
 };
 
 } // namespace scalechord
@@ -0,0 +1,40 @@
+// Worker pool for independent offline jobs (progression segments/sections)
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace scalechord {
+
+// Runs jobs 0..count-1 on up to maxThreads threads (0 = hardware concurrency),
+// the calling thread included, and returns when all are done. Workers pull jobs
+// off a shared counter. makeWorker() is called once per thread and returns the
+// callable that runs a job by index, so each worker can own its scratch state
+// (memo tables) and nothing but the counter is shared.
+template <typename MakeWorker>
+void runParallel(std::size_t count, int maxThreads, MakeWorker&& makeWorker) {
+    unsigned threads = maxThreads > 0 ? static_cast<unsigned>(maxThreads)
+                                      : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, count));
+
+    std::atomic<std::size_t> next{0};
+    auto work = [&]() {
+        auto job = makeWorker();
+        for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) job(i);
+    };
+
+    if (threads <= 1) {
+        work();
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (unsigned i = 1; i < threads; ++i) pool.emplace_back(work);
+        work();
+        for (std::thread& t : pool) t.join();
+    }
+}
+
+} // namespace scalechord
@@ -65,6 +65,7 @@ public:
         int peakVoiceCount = 0;        // Peak in current window
         float averageVoiceCount = 0.0f; // Average voices (smoothed)
         bool voiceActivity[MAX_VOICES]; // Individual voice states
+        int stealCount = 0;            // Voices stolen by the allocator (cumulative)
     };
 
     /**
@@ -177,6 +178,12 @@ public:
      */
     void updateVoiceMetrics(int activeVoiceCount, const bool voiceStates[MAX_VOICES]);
 
+    /**
+     * @brief Update voice stealing count
+     * @param totalSteals Cumulative steals reported by VoiceAllocator
+     */
+    void updateVoiceSteals(int totalSteals);
+
     /**
      * @brief Update CPU metrics for current block
      * @param cpuPercentage CPU usage as percentage (0-100)
@@ -0,0 +1,103 @@
+// 12-bit pitch-class set shared by the scale, chord and voice-leading code
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace scalechord {
+
+// Set of pitch classes (0-11) stored as a bitmask: bit n set = pitch class n present.
+// Everything is constexpr and allocation-free; use toVector() only at API edges.
+class PitchClassSet {
+public:
+    static constexpr uint16_t FULL_MASK = 0x0FFF;
+
+    constexpr PitchClassSet() noexcept = default;
+    constexpr explicit PitchClassSet(uint16_t mask) noexcept : mask_(mask & FULL_MASK) {}
+
+    // Pitch classes of MIDI notes (any int range), transposed so `root` becomes 0
+    template <typename Notes>
+    static constexpr PitchClassSet fromNotes(const Notes& notes, int root = 0) noexcept {
+        PitchClassSet set;
+        for (int note : notes) set.insert(note - root);
+        return set;
+    }
+
+    static constexpr int wrap(int pitch) noexcept { return ((pitch % 12) + 12) % 12; }
+
+    constexpr uint16_t mask() const noexcept { return mask_; }
+    constexpr bool contains(int pitch) const noexcept { return (mask_ >> wrap(pitch)) & 1u; }
+    constexpr void insert(int pitch) noexcept { mask_ = static_cast<uint16_t>(mask_ | (1u << wrap(pitch))); }
+    constexpr void erase(int pitch) noexcept { mask_ = static_cast<uint16_t>(mask_ & ~(1u << wrap(pitch))); }
+    constexpr bool empty() const noexcept { return mask_ == 0; }
+
+    // Number of pitch classes in the set
+    constexpr int size() const noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcount(mask_);
+#else
+        int n = 0;
+        for (uint16_t m = mask_; m; m &= m - 1) ++n;
+        return n;
+#endif
+    }
+
+    // Lowest pitch class in the set, -1 if empty
+    constexpr int lowest() const noexcept {
+        if (mask_ == 0) return -1;
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctz(mask_);
+#else
+        int pc = 0;
+        while (!((mask_ >> pc) & 1u)) ++pc;
+        return pc;
+#endif
+    }
+
+    // Transpose every pitch class up by `semitones` (negative = down), wrapping at the octave
+    constexpr PitchClassSet rotate(int semitones) const noexcept {
+        int s = wrap(semitones);
+        uint32_t m = mask_;
+        return PitchClassSet(static_cast<uint16_t>(((m << s) | (m >> (12 - s))) & FULL_MASK));
+    }
+
+    constexpr bool isSubsetOf(PitchClassSet other) const noexcept { return (mask_ & ~other.mask_) == 0; }
+
+    // Number of pitch classes in exactly one of the two sets
+    constexpr int hammingDistance(PitchClassSet other) const noexcept { return (*this ^ other).size(); }
+
+    constexpr PitchClassSet operator|(PitchClassSet o) const noexcept { return PitchClassSet(static_cast<uint16_t>(mask_ | o.mask_)); }
+    constexpr PitchClassSet operator&(PitchClassSet o) const noexcept { return PitchClassSet(static_cast<uint16_t>(mask_ & o.mask_)); }
+    constexpr PitchClassSet operator^(PitchClassSet o) const noexcept { return PitchClassSet(static_cast<uint16_t>(mask_ ^ o.mask_)); }
+    constexpr bool operator==(PitchClassSet o) const noexcept { return mask_ == o.mask_; }
+    constexpr bool operator!=(PitchClassSet o) const noexcept { return mask_ != o.mask_; }
+
+    // Iterates pitch classes in ascending order
+    class Iterator {
+    public:
+        constexpr explicit Iterator(uint16_t remaining) noexcept : remaining_(remaining) {}
+        constexpr int operator*() const noexcept { return PitchClassSet(remaining_).lowest(); }
+        constexpr Iterator& operator++() noexcept {
+            remaining_ = static_cast<uint16_t>(remaining_ & (remaining_ - 1));
+            return *this;
+        }
+        constexpr bool operator!=(const Iterator& o) const noexcept { return remaining_ != o.remaining_; }
+    private:
+        uint16_t remaining_;
+    };
+    constexpr Iterator begin() const noexcept { return Iterator(mask_); }
+    constexpr Iterator end() const noexcept { return Iterator(0); }
+
+    // Sorted pitch classes (0-11)
+    std::vector<int> toVector() const {
+        std::vector<int> out;
+        out.reserve(size());
+        for (int pc : *this) out.push_back(pc);
+        return out;
+    }
+
+private:
+    uint16_t mask_ = 0;
+};
+
+} // namespace scalechord
@@ -51,6 +51,8 @@ struct Preset {
         
         bool probabilityEnabled = false;
         float probabilityAmount = 0.5f;
+
+        int randomSeed = 0;            // 0 = fresh per instance, else reproducible randomness
     } midiEffects;
 };
 
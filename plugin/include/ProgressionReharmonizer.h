@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ChordAnalyzer.h"
+#include "JazzReharmonizer.h"
+#include "VoiceLeading.h"
+
+/**
+ * @brief Settings for progression reharmonization
+ *
+ * A path through the progression scores, per chord:
+ *   musicalityWeight * musicality (catalogue value, or originalMusicality
+ *   for the written chord)
+ * + smoothnessWeight * VoiceLeading smoothness from the previous chord
+ * + resolutionBonus when a dominant resolves down a fifth or half step to
+ *   a diatonic root
+ * - outOfKeyPenalty per pitch class outside the key
+ */
+struct ReharmonizerSettings {
+    int keyRoot = 0;                  // 0-11, 0 = C
+    bool majorKey = true;             // false = natural minor
+    int beamWidth = 8;                // partial paths kept per chord (offline)
+    float musicalityWeight = 1.0f;
+    float originalMusicality = 90.0f; // keeping the written chord
+    float smoothnessWeight = 0.5f;
+    float resolutionBonus = 15.0f;
+    float outOfKeyPenalty = 4.0f;
+    int maxThreads = 0;               // sections run in parallel; 0 = hardware concurrency
+};
+
+/**
+ * @brief One chord of a timeline
+ */
+struct TimelineChord {
+    double ppq = 0.0;                 // start in quarter notes
+    std::vector<int> notes;           // MIDI notes as written
+    bool sectionStart = false;        // a new section (verse, bridge...) starts here
+};
+
+/**
+ * @brief Reharmonized chord
+ */
+struct ReharmonizedChord {
+    double ppq = 0.0;
+    std::vector<int> notes;                       // voiced result, ascending
+    const Substitution* substitution = nullptr;   // catalogue entry, nullptr = written chord kept
+};
+
+/**
+ * @brief Reharmonized timeline
+ */
+struct ReharmonizationResult {
+    std::vector<ReharmonizedChord> chords;        // one per input chord
+    float totalScore = 0.0f;                      // summed over sections
+    int sectionCount = 0;
+};
+
+/**
+ * @class ProgressionReharmonizer
+ * @brief Chooses substitutions in context rather than chord by chord
+ *
+ * Each chord's options are the written chord plus the JazzReharmonizer
+ * catalogue entries for its scale degree (chords whose root is outside
+ * the key are kept as written). Options are reduced to a pitch-class
+ * key (mask | root << 12), so the context-dependent part of the score,
+ * the transition from the previous chord, is memoized by
+ * (key, previous chord key, chord key) in a fixed-size table: a
+ * progression revisiting the same changes costs lookups after the first
+ * pass. Transition smoothness comes from VoiceLeading on canonical
+ * (closed, root-position) voicings.
+ *
+ * **Offline** (reharmonize): beam search per section, keeping the best
+ * path per last option and then the beamWidth best overall. Sections
+ * are independent and run in parallel, each worker with its own memo
+ * table. Chosen substitutes are voiced against the previous output
+ * with VoiceLeading::optimizeVoicing; the written chord is kept as is.
+ *
+ * **Real time** (nextChord): a chord that has sounded cannot change, so
+ * the best path is extended one chord at a time from the committed
+ * previous chord. It does not allocate.
+ */
+class ProgressionReharmonizer {
+public:
+    static constexpr int MAX_OPTIONS = 16;   // written chord + catalogue entries
+    static constexpr int MAX_NOTES = 12;     // room nextChord() needs in `out`
+
+    ProgressionReharmonizer();
+    explicit ProgressionReharmonizer(const ReharmonizerSettings& settings);
+
+    // Changing a scoring weight clears the real-time memo (not real-time safe then)
+    void setSettings(const ReharmonizerSettings& settings);
+    const ReharmonizerSettings& getSettings() const noexcept { return settings_; }
+
+    /**
+     * @brief Reharmonize a whole timeline (offline; allocates, may start threads)
+     */
+    ReharmonizationResult reharmonize(const std::vector<TimelineChord>& timeline) const;
+
+    /**
+     * @brief Reharmonize the next chord as it arrives (audio thread)
+     *
+     * @param notes Chord as played
+     * @param numNotes Number of notes
+     * @param out Receives the voiced result (room for MAX_NOTES)
+     * @param chosen Optional: receives the substitution (nullptr = kept)
+     * @return Number of notes written
+     */
+    int nextChord(const int* notes, int numNotes, int* out, const Substitution** chosen = nullptr);
+
+    /**
+     * @brief Forget the committed chord (transport stop, new song)
+     */
+    void reset() noexcept { numPrevious_ = 0; }
+
+private:
+    struct Option {
+        const Substitution* substitution;   // nullptr = written chord
+        uint16_t chordKey;                  // pitch classes | root << 12
+        float score;                        // musicality - out-of-key penalty
+    };
+
+    // Direct-mapped memo of transition scores; collisions overwrite
+    struct TransitionCache {
+        static constexpr int SIZE = 4096;
+        struct Entry {
+            uint64_t key = 0;               // 0 = empty
+            float value = 0.0f;
+        };
+        Entry entries[SIZE];
+    };
+
+    ReharmonizerSettings settings_;
+    VoiceLeading voiceLeading_;
+    JazzReharmonizer jazz_;
+
+    // Real-time state
+    std::unique_ptr<TransitionCache> realtimeCache_;
+    uint16_t previousKey_ = 0;
+    int previousNotes_[MAX_NOTES] = {};
+    int numPrevious_ = 0;
+
+    int buildOptions(const int* notes, int numNotes, Option* out) const;
+    float transition(uint16_t previousKey, uint16_t chordKey, TransitionCache& cache) const;
+    static int canonicalVoicing(uint16_t chordKey, int* out);
+
+    // Chosen notes for an option, voiced from `previous` (the written chord when none)
+    int voiceOption(const Option& option, const int* written, int numWritten,
+                    const int* previous, int numPrevious, int* out) const;
+
+    // Beam search over timeline[begin, end); returns the best path score
+    float reharmonizeSection(const std::vector<TimelineChord>& timeline, size_t begin, size_t end,
+                             TransitionCache& cache, std::vector<ReharmonizedChord>& out) const;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Settings for whole-progression voicing
+ */
+struct ProgressionVoicerSettings {
+    int candidatesPerChord = 16;  // K best voicings kept per chord (max MAX_CANDIDATES)
+    int lowestNote = 40;          // voicings start at or above this (E2)
+    int highestNote = 84;         // notes above this are penalized (C6)
+    int centerNote = 60;          // ties between candidates favor this register
+    bool keepBass = true;         // keep each input chord's lowest pitch class in the bass
+    float movementWeight = 1.0f;  // per semitone of voice movement
+    float rangePenalty = 4.0f;    // per semitone above highestNote
+    int maxSpacing = 12;          // wider gaps between adjacent notes are penalized...
+    float spacingPenalty = 1.0f;  // ...per semitone over maxSpacing
+    int segmentLength = 128;      // chords per independent segment; 0 = never split
+    int maxThreads = 0;           // segments run in parallel; 0 = hardware concurrency
+};
+
+/**
+ * @brief Optimized voicings for a whole progression
+ */
+struct ProgressionVoicingResult {
+    std::vector<std::vector<int>> voicings;  // one per input chord, ascending (empty for rests)
+    float totalCost = 0.0f;                  // movement + penalties, summed over segments
+    int segmentCount = 0;
+};
+
+/**
+ * @class ProgressionVoicer
+ * @brief Offline voice leading over a whole progression
+ *
+ * VoiceLeading optimizes one chord change at a time, so an early choice
+ * can force a large leap later. ProgressionVoicer instead picks the voicing
+ * sequence with the lowest total cost over the progression:
+ *
+ * 1. **Candidates**: every voicing of the chord's pitch classes with the
+ *    bass in [lowestNote, highestNote] and the other notes within two
+ *    octaves above it, scored for range and spacing; the K best are kept.
+ *
+ * 2. **Viterbi**: a DP over chords x K candidates minimizing
+ *    movement + penalties, O(chords * K^2).
+ *
+ * Candidates depend only on the chord's pitch classes (and bass), and
+ * transition costs only on a pair of them, so both are memoized by
+ * pitch-class key: a tune built from a dozen chord types costs a dozen
+ * candidate sets and a few dozen K x K tables, however long it is.
+ *
+ * Long files are split every segmentLength chords into segments that
+ * are optimized independently (and in parallel, each worker with its own
+ * memo tables). Segment boundaries are not linked, so keep segments at
+ * phrase length or longer.
+ *
+ * Not real-time safe: allocates and may start threads.
+ *
+ * @code
+ * ProgressionVoicer voicer;
+ * auto result = voicer.optimize({{62, 65, 69, 72}, {55, 59, 62, 65}, {60, 64, 67, 71}});
+ * // result.voicings holds Dm7 - G7 - Cmaj7 with minimal movement
+ * @endcode
+ */
+class ProgressionVoicer {
+public:
+    static constexpr int MAX_CANDIDATES = 32;
+    static constexpr int MAX_NOTES = 8;  // pitch classes beyond 8 (from the top) are dropped
+
+    ProgressionVoicer() = default;
+    explicit ProgressionVoicer(const ProgressionVoicerSettings& settings);
+
+    void setSettings(const ProgressionVoicerSettings& settings);
+    const ProgressionVoicerSettings& getSettings() const noexcept { return settings_; }
+
+    /**
+     * @brief Voice every chord of a progression (MIDI notes; empty = rest)
+     *
+     * Only pitch classes (and, with keepBass, the lowest note's pitch
+     * class) of the input are used. Rests break voice leading: the chord
+     * after a rest is voiced freely.
+     */
+    ProgressionVoicingResult optimize(const std::vector<std::vector<int>>& chords) const;
+
+    /**
+     * @brief Cost of a given voicing sequence under the same model
+     *
+     * Lets callers compare the optimizer against any other voicing
+     * (including the input itself).
+     */
+    float scoreVoicings(const std::vector<std::vector<int>>& voicings) const;
+
+private:
+    struct Voicing {
+        std::array<int8_t, MAX_NOTES> notes{};  // ascending
+        int size = 0;
+        float cost = 0.0f;                      // range + spacing penalties
+    };
+
+    // Per-worker memo tables, keyed by pitch-class key (mask | bass << 12)
+    struct Cache {
+        std::unordered_map<uint16_t, std::vector<Voicing>> candidates;
+        std::unordered_map<uint32_t, std::vector<float>> transitions;  // row-major from x to
+    };
+
+    ProgressionVoicerSettings settings_;
+
+    uint16_t chordKey(const std::vector<int>& chord) const;
+    float staticCost(const Voicing& v) const;
+    static float movement(const Voicing& from, const Voicing& to);
+
+    const std::vector<Voicing>& candidatesFor(uint16_t key, Cache& cache) const;
+    const std::vector<float>& transitionsFor(uint16_t from, uint16_t to, Cache& cache) const;
+
+    // Viterbi over keys[begin, end); writes voicings and returns the path cost
+    float optimizeSegment(const std::vector<uint16_t>& keys, size_t begin, size_t end,
+                          Cache& cache, std::vector<std::vector<int>>& out) const;
+};
@@ -3,6 +3,10 @@
 
 #include <vector>
 #include <string>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "PitchClassSet.h"
 
 namespace scalechord {
 
@@ -33,14 +37,20 @@ enum class ScaleType {
     Diminished = 14,     // Whole-half alternating
 };
 
+struct ScaleTable;
+
 struct MapperSettings {
     int rootNote = 0; // 0 = C, 1 = C#, ... 11 = B
     ScaleType scale = ScaleType::Ionian;
 };
 
+// Thread safety: setSettings() may be called from the message thread while the
+// audio thread maps notes. All state lives in one immutable static ScaleTable
+// that is published with an atomic pointer store, so readers never see a torn
+// table and nothing is allocated or freed.
 class ScaleMapper {
 public:
-    ScaleMapper() = default;
+    ScaleMapper();
     explicit ScaleMapper(const MapperSettings& s);
 
     void setSettings(const MapperSettings& s);
@@ -50,15 +60,32 @@ public:
     // Returns a MIDI note (0-127).
     int mapNote(int incomingMidiNote) const;
 
-    // Optimized lookup table version - call buildLookupTable() first
-    // Much faster than mapNote() for repeated calls with same settings
+    // Lookup table version - reads the precomputed table for the current scale/root
     int mapNoteFast(int incomingMidiNote) const;
     
-    // Build the internal lookup table for mapNoteFast()
-    void buildLookupTable() const;
+    // Batch version of mapNoteFast() for offline rendering / re-harmonization.
+    // Maps count notes from in[] to out[] against one table snapshot; in and out
+    // may alias. The byte overload uses an SSSE3/AVX2 nibble lookup when the CPU
+    // has it, picked at runtime (values above 127 are clamped, like mapNoteFast()).
+    void mapNotes(const uint8_t* in, uint8_t* out, std::size_t count) const noexcept;
+    void mapNotes(const int* in, int* out, std::size_t count) const noexcept;
+
+    // Byte mapNotes() paths; bestSimdPath() is what the CPU running us supports
+    enum class SimdPath { Scalar, SSSE3, AVX2 };
+    static SimdPath bestSimdPath() noexcept;
+
+    // mapNotes() through a given path (lowered to bestSimdPath() if the CPU
+    // lacks it), so tests and benchmarks can check SIMD against scalar
+    void mapNotes(const uint8_t* in, uint8_t* out, std::size_t count, SimdPath path) const noexcept;
+
+    // Kept for compatibility: tables are generated at compile time, nothing to build
+    void buildLookupTable() const {}
 
     // Return the scale degrees in semitones relative to root (sorted ascending, within one octave)
     std::vector<int> getScaleSemitones() const;
+
+    // Precomputed table for the current settings (see ScaleTables.h)
+    const ScaleTable& getScaleTable() const noexcept { return *table_.load(std::memory_order_acquire); }
     
     // Get scale degree index (0-6 for heptatonic, etc.) for a given semitone
     int getScaleDegree(int semitoneInOctave) const;
@@ -67,19 +94,14 @@ public:
     // Returns intervals as semitone offsets from root
     std::vector<int> getChordIntervalsForDegree(int degree, int chordQuality = 0) const;
     
-    // Detect scale from a set of pitch classes
+    // Detect scale from a set of pitch classes (one-shot; KeyTracker follows a live stream)
     static ScaleType detectScale(const std::vector<int>& pitchClasses, int& outRootNote);
+    static ScaleType detectScale(PitchClassSet pitchClasses, int& outRootNote);
 
     static std::string scaleName(ScaleType t);
 
 private:
-    MapperSettings settings_;
-    std::vector<int> scaleSemitones_; // computed from settings
-    mutable std::vector<int> lookupTable_;  // Cache for mapNoteFast() - all 128 MIDI notes
-    mutable bool lookupTableValid_ = false;  // Flag to detect when settings change
-
-    void rebuildScale();
-    int quantizeToScale(int midiNote) const;
+    std::atomic<const ScaleTable*> table_; // static table for the current settings, swapped on setSettings()
 };
 
 } // namespace scalechord
@@ -0,0 +1,43 @@
+// Compile-time scale tables shared by ScaleMapper and ChordVoicer
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "PitchClassSet.h"
+#include "ScaleMapper.h"
+
+namespace scalechord {
+
+constexpr int NUM_SCALE_TYPES = static_cast<int>(ScaleType::Diminished) + 1;
+constexpr int MAX_SCALE_DEGREES = 8;
+
+// Interval pattern of a scale relative to its root (ascending, within one octave)
+struct ScaleIntervals {
+    std::array<uint8_t, MAX_SCALE_DEGREES> semitones;
+    uint8_t size;
+};
+
+// Everything ScaleMapper/ChordVoicer need for one (scale, root) pair.
+// All 15 x 12 tables are generated at compile time, so switching scale or
+// root is a pointer swap with no allocation.
+struct ScaleTable {
+    std::array<uint8_t, MAX_SCALE_DEGREES> semitones;  // pitch classes with root applied, sorted ascending
+    uint8_t size;                                      // number of valid entries in semitones
+    std::array<int8_t, 12> degreeOf;                   // pitch class -> index into semitones, -1 if not in scale
+    std::array<uint8_t, 128> noteMap;                  // MIDI note -> nearest in-scale MIDI note
+    PitchClassSet pitchClasses;                        // the same pitch classes as a bitmask
+    ScaleType scale;                                   // settings this table was generated for
+    uint8_t rootNote;
+};
+
+// Interval pattern for a scale type (unknown values fall back to Ionian)
+const ScaleIntervals& scaleIntervals(ScaleType t) noexcept;
+
+// Precomputed table for a scale type and root (root is wrapped into 0-11)
+const ScaleTable& scaleTable(ScaleType t, int rootNote) noexcept;
+
+// Scale/root containing the most of the given pitch classes (earliest root, then
+// scale type, on ties). One lookup into a 4096-entry table built on first use.
+const ScaleTable& bestScaleTable(PitchClassSet pitchClasses) noexcept;
+
+} // namespace scalechord
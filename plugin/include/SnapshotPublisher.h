@@ -0,0 +1,78 @@
+// Lock-free publication of immutable settings snapshots (RCU style)
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace scalechord {
+
+// Holds the current immutable snapshot of some settings-derived state.
+//
+// Writer side (message/UI thread, one writer at a time): build a new T off the
+// audio thread and hand it to publish(). The previous snapshot is retired and
+// deleted on a later writer call once no reader can still be using it.
+//
+// Reader side (audio thread, any number of readers): take a ReadGuard, use the
+// snapshot, let the guard go. Readers never allocate, lock or free.
+template <typename T>
+class SnapshotPublisher {
+public:
+    SnapshotPublisher() = default;
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    ~SnapshotPublisher() {
+        delete current_.load();
+        for (T* old : retired_) delete old;
+    }
+
+    // Writer: swap in a new snapshot (takes ownership)
+    void publish(std::unique_ptr<T> next) {
+        T* old = current_.exchange(next.release());
+        if (old) retired_.push_back(old);
+        collectGarbage();
+    }
+
+    // Writer: delete retired snapshots no reader can still see. Any reader that
+    // starts after the exchange in publish() loads the new pointer, so once the
+    // active reader count has been seen at zero the retired list is unreachable.
+    void collectGarbage() {
+        if (!retired_.empty() && activeReaders_.load() == 0) {
+            for (T* old : retired_) delete old;
+            retired_.clear();
+        }
+    }
+
+    // Writer: the most recently published snapshot (nullptr before first publish)
+    const T* writerView() const noexcept { return current_.load(); }
+
+    // Reader: RAII access to the current snapshot
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const SnapshotPublisher& p) noexcept : owner_(p) {
+            owner_.activeReaders_.fetch_add(1);
+            snapshot_ = owner_.current_.load();
+        }
+        ~ReadGuard() { owner_.activeReaders_.fetch_sub(1); }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T* get() const noexcept { return snapshot_; }
+        const T* operator->() const noexcept { return snapshot_; }
+        explicit operator bool() const noexcept { return snapshot_ != nullptr; }
+
+    private:
+        const SnapshotPublisher& owner_;
+        const T* snapshot_ = nullptr;
+    };
+
+    ReadGuard read() const noexcept { return ReadGuard(*this); }
+
+private:
+    std::atomic<T*> current_{nullptr};
+    mutable std::atomic<int> activeReaders_{0};
+    std::vector<T*> retired_;  // writer thread only
+};
+
+} // namespace scalechord
@@ -0,0 +1,106 @@
+// Polyphonic voice allocator - hard polyphony budget for generated chord notes
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace scalechord {
+
+enum class StealPolicy {
+    Oldest,     // steal the voice that started first
+    Quietest,   // steal the lowest-velocity voice (oldest among equals)
+    Highest,    // steal the highest pitch
+    Lowest,     // steal the lowest pitch
+};
+
+struct VoiceAllocatorSettings {
+    int maxVoices = 16;                    // 1 - VoiceAllocator::MAX_POLYPHONY
+    StealPolicy policy = StealPolicy::Oldest;
+};
+
+// Result of a note-on. If stolenNote >= 0 the caller must send a note-off for it
+// before the note-on (for a same-pitch reuse stolenNote is the new note itself).
+struct VoiceAllocation {
+    int voice = -1;                        // voice index, -1 if the note was rejected
+    int stolenNote = -1;
+    bool samePitchReuse = false;
+};
+
+// Each sounding pitch owns at most one voice: a note-on for a pitch that is
+// already sounding reuses its voice (retrigger) before any stealing happens.
+// Otherwise a free voice is taken, and only when all maxVoices are busy is one
+// stolen by the configured policy. Every operation is O(1): the per-voice
+// state is stored as parallel arrays (SoA), the age order is an intrusive list,
+// quietest/highest/lowest come from 128-bit occupancy bitmaps, and there is no
+// allocation after construction.
+class VoiceAllocator {
+public:
+    static constexpr int MAX_POLYPHONY = 64;
+
+    VoiceAllocator();
+    explicit VoiceAllocator(const VoiceAllocatorSettings& s);
+
+    // Lowering maxVoices does not cut sounding voices; they drain as they end
+    void setSettings(const VoiceAllocatorSettings& s);
+    VoiceAllocatorSettings getSettings() const noexcept { return settings_; }
+
+    VoiceAllocation noteOn(int note, int velocity) noexcept;
+
+    // Free the voice playing `note`. Returns false if no voice holds it (e.g. it
+    // was stolen), in which case no note-off should be sent.
+    bool noteOff(int note) noexcept;
+
+    bool isSounding(int note) const noexcept;
+    int getActiveVoiceCount() const noexcept { return activeCount_; }
+
+    // Pitch on a voice, -1 if the voice is free
+    int getVoiceNote(int voice) const noexcept;
+
+    // Voice playing a pitch, -1 if it is not sounding
+    int getVoiceForNote(int note) const noexcept {
+        return (note >= 0 && note < 128) ? voiceForPitch_[note] : -1;
+    }
+
+    // Per-voice activity for the dashboard (writes `count` entries)
+    void getVoiceStates(bool* out, int count) const noexcept;
+
+    // Cumulative counters since construction (reset() keeps them)
+    int getStealCount() const noexcept { return stealCount_; }
+    int getSamePitchReuseCount() const noexcept { return reuseCount_; }
+
+    // Free every voice without reporting note-offs (e.g. after All Notes Off)
+    void reset() noexcept;
+
+private:
+    using Bitmap128 = std::array<uint64_t, 2>;
+
+    VoiceAllocatorSettings settings_;
+
+    // Per-voice state (structure of arrays)
+    std::array<int8_t, MAX_POLYPHONY> pitch_;      // -1 = free
+    std::array<uint8_t, MAX_POLYPHONY> velocity_;
+    std::array<int8_t, MAX_POLYPHONY> olderVoice_; // age list links
+    std::array<int8_t, MAX_POLYPHONY> newerVoice_;
+    std::array<int8_t, MAX_POLYPHONY> nextSameVelocity_;  // per-velocity lists, oldest first
+    std::array<int8_t, MAX_POLYPHONY> prevSameVelocity_;
+
+    // Indexes
+    uint64_t freeVoices_ = 0;                      // bit per free voice
+    std::array<int8_t, 128> voiceForPitch_;        // -1 = not sounding
+    std::array<int8_t, 128> velocityHead_;         // oldest voice at each velocity
+    std::array<int8_t, 128> velocityTail_;
+    Bitmap128 soundingPitches_{};
+    Bitmap128 usedVelocities_{};
+    int8_t oldest_ = -1;
+    int8_t newest_ = -1;
+    int activeCount_ = 0;
+
+    int stealCount_ = 0;
+    int reuseCount_ = 0;
+
+    int chooseVictim() const noexcept;
+    void assign(int voice, int note, int velocity) noexcept;
+    void release(int voice) noexcept;
+};
+
+} // namespace scalechord
@@ -2,7 +2,9 @@
 
 #include <vector>
 #include <cmath>
+#include <cstdint>
 #include "ChordAnalyzer.h"
+#include "PitchClassSet.h"
 
 /**
  * @brief Result of voice leading analysis
@@ -93,15 +95,42 @@ public:
         const std::vector<int>& targetChord,
         int octaveRange = 2) const;
 
+    /**
+     * @brief Allocation-free optimizeVoicing for the audio thread
+     *
+     * Places each distinct target pitch class once (ascending in `out`,
+     * which needs room for numTarget notes) and returns how many were
+     * written. With up to MAX_EXACT_VOICES voices on either side the
+     * result has the minimal total movement: every current voice is
+     * matched to a target pitch class at its nearest octave (extra voices
+     * drop out, extra pitch classes split off their nearest voice) by a
+     * bitmask DP over a fixed 8x8 cost matrix. That is at most
+     * 8 * 2^8 steps, so the worst case is bounded regardless of input.
+     * Larger chords fall back to placing each pitch class near its
+     * closest current voice.
+     *
+     * @param octaveRange 0 keeps each note in its source voice's octave
+     *        where MIDI range allows; any other value allows the
+     *        nearest octave either way
+     */
+    int optimizeVoicing(
+        const int* currentChord, int numCurrent,
+        const int* targetChord, int numTarget,
+        int* out, int octaveRange = 2) const;
+
+    static constexpr int MAX_EXACT_VOICES = 8;
+
     /**
      * @brief Score voice leading smoothness (0-100)
      * 
      * Calculates smoothness based on:
      * - Total semitone distance moved (lower = smoother)
      * - Presence of common tones (higher = smoother)
-     * - Voice crossing prevention (avoiding = smoother)
+     * - Parallel fifths/octaves (voices i < j, ascending, moving the same
+     *   direction into the unison/octave or fifth they started from)
      * 
-     * Formula: 100 - (distance_penalty * 0.5) + (common_tone_bonus * 10)
+     * Formula: 100 - min(2 * average_distance, 80) + 8 * common_tones
+     *          - PARALLEL_PENALTY * parallels
      * Result clamped to 0-100 range.
      * 
      * @param from First chord (MIDI notes)
@@ -125,6 +154,32 @@ public:
         const std::vector<int>& from,
         const std::vector<int>& to) const;
 
+    /**
+     * @brief Score many candidate voicings against one source chord
+     *
+     * Candidates are packed as numCandidates rows of BATCH_WIDTH int8 MIDI
+     * notes: voices from lane 0, unused lanes -1. outScores[i] equals
+     * scoreVoiceLeading(from, row i). With SSE2 two rows are scored per
+     * register (distance via SAD, common tones and parallels via byte
+     * compares), with no allocation. Sources longer than BATCH_WIDTH fall
+     * back to the scalar version.
+     *
+     * @code
+     * int8_t rows[2][VoiceLeading::BATCH_WIDTH] = {
+     *     {60, 65, 69, -1, -1, -1, -1, -1},   // F/C
+     *     {65, 69, 72, -1, -1, -1, -1, -1}};  // F
+     * float scores[2];
+     * voiceLeading.scoreVoiceLeadingBatch(cmaj, 3, rows[0], 2, scores);
+     * @endcode
+     */
+    void scoreVoiceLeadingBatch(
+        const int* from, int numFrom,
+        const int8_t* candidates, int numCandidates,
+        float* outScores) const;
+
+    static constexpr int BATCH_WIDTH = 8;
+    static constexpr float PARALLEL_PENALTY = 10.0f;
+
     /**
      * @brief Suggest smoother voicing for chord transition
      * 
@@ -209,10 +264,40 @@ private:
     static int findBestOctave(
         int currentNote, int targetPitchClass, int octaveRange);
 
+    /**
+     * @brief Nearest placement of a pitch class to a source note
+     *
+     * Like findBestOctave, but never leaves the MIDI range and only
+     * looks one octave either way (the nearest placement is always
+     * within 6 semitones). Ties keep the source octave, then go down.
+     */
+    static int placeNear(int sourceNote, int pitchClass, int octaveRange);
+
+    /**
+     * @brief Movement cost of every (current voice, target pitch class) pair
+     *
+     * Row i holds placeNear distances from currentChord[i] to the 8
+     * lanes of pitchClasses (SSE2 when available, 8 x int16 per row).
+     */
+    static void computeCostRows(
+        const int* currentChord, int numCurrent,
+        const int16_t* pitchClasses, int octaveRange,
+        int16_t (*cost)[MAX_EXACT_VOICES]);
+
     /**
      * @brief Get pitch class set from chord (deduplicated)
      * @param chord Input MIDI notes
-     * @return Sorted vector of unique pitch classes (0-11)
+     * @return Bitmask of pitch classes (0-11), iterates in ascending order
+     */
+    static scalechord::PitchClassSet getPitchClassSet(const std::vector<int>& chord);
+
+    /**
+     * @brief Score formula shared by the single and batch versions
+     */
+    static float smoothness(int totalDistance, int voices, int commonTones, int parallels);
+
+    /**
+     * @brief Parallel fifths/octaves between the first `voices` voices
      */
-    static std::vector<int> getPitchClassSet(const std::vector<int>& chord);
+    static int countParallels(const int* from, const int* to, int voices);
 };
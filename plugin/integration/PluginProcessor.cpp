@@ -1,6 +1,7 @@
 #if defined(JUCE_MODULE_AVAILABLE_juce_audio_processors)
 
 #include "PluginProcessor.h"
+#include "../include/ScaleTables.h"
 #include <algorithm>
 #include <sstream>
 
@@ -25,9 +26,15 @@ PluginProcessor::PluginProcessor()
 
     // Initialize MIDI note tracker for polyphonic handling
     noteTracker_.initialize(16);  // 16 simultaneous voices
+
+    // Rebuilds the voicing cache after key changes made on the audio thread
+    startTimerHz(10);
 }
 
-PluginProcessor::~PluginProcessor() = default;
+PluginProcessor::~PluginProcessor()
+{
+    stopTimer();
+}
 
 // ============================================================================
 // AudioProcessor Core Overrides
@@ -38,11 +45,15 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     sampleRate_ = sampleRate;
     samplesPerBlock_ = samplesPerBlock;
 
+    // Pending gates/delays keep their length in seconds across rate changes
+    scheduler_.setSampleRate(sampleRate);
+
     // Initialize all module-specific settings
     updateSettings();
 
-    // Prepare envelope with sample rate
-    envelope_.setSampleRate(sampleRate);
+    // Prepare envelopes with sample rate
+    envelopes_.setSampleRate(static_cast<float>(sampleRate));
+    modulation_.setSampleRate(sampleRate);
 
     juce::ignoreUnused(sampleRate, samplesPerBlock);
 }
@@ -51,6 +62,8 @@ void PluginProcessor::releaseResources()
 {
     // Clean up any real-time resources
     noteTracker_.reset();
+    scheduler_.clear();
+    outputStage_.reset();
 }
 
 void PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
@@ -60,10 +73,45 @@ void PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiB
 
     juce::MidiBuffer processedMidi;
 
+    // Follow host tempo; on transport stop release anything still scheduled
+    if (auto* playHead = getPlayHead())
+    {
+        if (auto position = playHead->getPosition())
+        {
+            if (auto bpm = position->getBpm())
+                scheduler_.setTempo(*bpm);
+
+            const bool playing = position->getIsPlaying();
+            if (wasPlaying_ && !playing)
+            {
+                reharmonizer_.reset();
+                scheduler_.flush([this, &processedMidi](const ScheduledMidiEvent& e, int offset) {
+                    processScheduledEvent(e, offset, processedMidi);
+                });
+            }
+            wasPlaying_ = playing;
+        }
+    }
+
+    // Scheduled events (note gates) are delivered in sample order with the
+    // incoming MIDI: everything due before a message is handled before it
+    blockStartTime_ = scheduler_.getCurrentTime();
+    int scheduledUpTo = 0;
+    auto deliverScheduled = [this, &processedMidi, &scheduledUpTo](int upTo) {
+        if (upTo <= scheduledUpTo) return;
+        const int chunkStart = scheduledUpTo;
+        scheduledUpTo = upTo;
+        scheduler_.processBlock(upTo - chunkStart,
+            [this, &processedMidi, chunkStart](const ScheduledMidiEvent& e, int offset) {
+                processScheduledEvent(e, chunkStart + offset, processedMidi);
+            });
+    };
+
     // Iterate through incoming MIDI messages
     for (const auto metadata : midiMessages)
     {
         const auto msg = metadata.getMessage();
+        deliverScheduled(metadata.samplePosition);
 
         // Check MIDI channel routing
         if (midiInputChannel_ != 0 && msg.getChannel() != midiInputChannel_) {
@@ -91,6 +139,33 @@ void PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiB
             processedMidi.addEvent(msg, metadata.samplePosition);
         }
     }
+    deliverScheduled(buffer.getNumSamples());
+
+    // Advance all voice envelopes by the block and render them as MIDI
+    // modulation (thinned, so DIN-speed outputs are not flooded)
+    envelopes_.process(buffer.getNumSamples());
+    const int modulationPosition = std::max(0, buffer.getNumSamples() - 1);
+    modulation_.process(envelopes_.getLevels(), buffer.getNumSamples(),
+        [&processedMidi, modulationPosition](uint8_t status, uint8_t data1, uint8_t data2) {
+            if ((status & 0xF0) == 0xD0)
+                processedMidi.addEvent(juce::MidiMessage(status, data1), modulationPosition);
+            else
+                processedMidi.addEvent(juce::MidiMessage(status, data1, data2), modulationPosition);
+        });
+
+    // Report polyphony to the dashboard
+    bool voiceStates[PerformanceDashboard::MAX_VOICES];
+    voiceAllocator_.getVoiceStates(voiceStates, PerformanceDashboard::MAX_VOICES);
+    dashboard_.updateVoiceMetrics(voiceAllocator_.getActiveVoiceCount(), voiceStates);
+
+    // Emit the block's coalesced note events
+    outputStage_.drainEvents([&processedMidi](const MidiNoteEvent& e) {
+        const int channel = e.channel + 1;  // JUCE uses 1-16
+        if (e.type == MidiNoteEvent::Type::NoteOn)
+            processedMidi.addEvent(juce::MidiMessage::noteOn(channel, e.note, e.velocity), e.samplePosition);
+        else
+            processedMidi.addEvent(juce::MidiMessage::noteOff(channel, e.note, static_cast<juce::uint8>(0)), e.samplePosition);
+    });
 
     // Replace incoming MIDI with processed output
     midiMessages.swapWith(processedMidi);
@@ -110,67 +185,153 @@ void PluginProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juc
 void PluginProcessor::processNoteOn(int noteNumber, int velocity, int samplePosition, 
                                     juce::MidiBuffer& outputBuffer)
 {
+    juce::ignoreUnused(outputBuffer);  // note events go through outputStage_
+
+    // New press of this key: gates from earlier presses no longer apply
+    const uint32_t press = ++pressGeneration_[noteNumber & 127];
+
     // Analyze incoming note for chord recognition
     analyzeAndSuggest(noteNumber);
 
+    // Follow the player's key. The mapper switch is a pointer store; the voicing
+    // cache falls back to direct voicing until timerCallback() rebuilds it.
+    // The tracker is audio-thread state, so a reset asked for by
+    // setAutoFollowKey() is carried out here, before the next note goes in.
+    if (keyTrackerResetPending_.exchange(false, std::memory_order_acquire))
+        keyTracker_.reset();
+    if (keyTracker_.noteOn(noteNumber, velocity) && autoFollowKey_.load(std::memory_order_relaxed)) {
+        KeyEstimate key = keyTracker_.getKey();
+        rootNote_ = key.rootNote;
+        scaleType_ = static_cast<int>(key.scale);
+        MapperSettings mapperSettings;
+        mapperSettings.rootNote = rootNote_;
+        mapperSettings.scale = key.scale;
+        scaleMapper_.setSettings(mapperSettings);
+        voicingCacheStale_.store(true, std::memory_order_release);
+    }
+
     // Map incoming note to scale
     int mappedNote = scaleMapper_.mapNote(noteNumber);
 
-    // Generate chord from mapped note
-    auto chord = chordVoicer_.makeChordFromNote(mappedNote);
-
-    // Track the note internally
-    noteTracker_.noteOn(noteNumber, velocity);
+    // Look up chord for mapped note (cached per scale/voicing, no allocation)
+    ChordBuffer chord = chordVoicer_.getCachedChord(mappedNote);
 
-    // Apply voice leading if multiple voices
+    // Apply voice leading if multiple voices (exact solver, bounded cost, no allocation)
     if (chord.size() > 1) {
-        chord = voiceLeading_.optimizeVoicing(chord, voiceLeading_.getLastVoicing());
+        int voiced[ChordBuffer::capacity()];
+        int count = voiceLeading_.optimizeVoicing(lastVoicing_.begin(), lastVoicing_.size(),
+                                                  chord.begin(), chord.size(), voiced);
+        chord.clear();
+        for (int i = 0; i < count; ++i) chord.push_back(voiced[i]);
+        lastVoicing_ = chord;
     }
 
-    // Check for jazz reharmonization
+    // Check for jazz reharmonization: extend the progression from the last
+    // chord sent (no allocation; ChordBuffer keeps the lowest 8 notes)
     if (scaleType_ >= 8) {  // Jazz/advanced scales
-        auto reharmonized = jazzReharmonizer_.reharmonize(chord);
-        if (!reharmonized.empty()) {
-            chord = reharmonized;
+        ReharmonizerSettings settings = reharmonizer_.getSettings();
+        settings.keyRoot = rootNote_;
+        // Major unless the scale has a minor third and no major third
+        const PitchClassSet scalePitches = scaleTable(static_cast<ScaleType>(scaleType_), 0).pitchClasses;
+        settings.majorKey = scalePitches.contains(4) || !scalePitches.contains(3);
+        reharmonizer_.setSettings(settings);
+
+        int reharmonized[ProgressionReharmonizer::MAX_NOTES];
+        int count = reharmonizer_.nextChord(chord.begin(), chord.size(), reharmonized);
+        if (count > 0) {
+            chord.clear();
+            for (int i = 0; i < count; ++i) chord.push_back(reharmonized[i]);
         }
     }
 
-    // Send note-ons for generated chord
-    for (int note : chord)
+    // Re-pressed before its note-off: the tracker is about to forget the old
+    // chord, so release its holds now or they would never be let go. Pitches
+    // the new chord shares are re-sounded below at the same sample, which the
+    // output stage merges.
+    if (noteTracker_.isNotePlaying(noteNumber))
+        releaseGeneratedNotes(noteNumber, samplePosition);
+
+    // Track the final chord so the note-off releases exactly what was sent
+    noteTracker_.trackNoteOn(noteNumber, chord, velocity, samplePosition);
+
+    // Fixed note length: schedule the release, possibly several blocks ahead,
+    // tagged with this press so it cannot release a later one
+    if (noteDuration_ > 0)
     {
-        juce::MidiMessage m = juce::MidiMessage::noteOn(
-            midiOutputChannel_ + 1,  // JUCE uses 1-16
-            note,
-            static_cast<juce::uint8>(velocity));
-        outputBuffer.addEvent(m, samplePosition);
+        const int64_t gateSamples = static_cast<int64_t>(noteDuration_ * 0.001 * sampleRate_);
+        scheduler_.scheduleAt(blockStartTime_ + samplePosition + gateSamples,
+                              0x80, static_cast<uint8_t>(noteNumber), 0, press);
     }
 
-    // Envelope attack
-    envelope_.noteOn(velocity / 127.0f);
+    // Queue note-ons for the generated chord, within the polyphony budget.
+    // A pitch another held note already sounds only gains a holder in the
+    // output stage; it needs no new voice and no second note-on.
+    for (int note : chord)
+    {
+        if (!outputStage_.isSounding(midiOutputChannel_, note))
+        {
+            VoiceAllocation voice = voiceAllocator_.noteOn(note, velocity);
+            if (voice.stolenNote >= 0)
+            {
+                outputStage_.forceNoteOff(midiOutputChannel_, voice.stolenNote, samplePosition);
+                noteTracker_.removeOutputNote(voice.stolenNote);
+                modulation_.stopVoice(voice.voice);
+            }
+            envelopes_.noteOn(voice.voice, velocity);  // per-voice envelope attack
+            modulation_.startVoice(voice.voice, note, midiOutputChannel_);
+        }
+        outputStage_.noteOn(midiOutputChannel_, note, velocity, samplePosition);
+    }
+    dashboard_.updateVoiceSteals(voiceAllocator_.getStealCount());
 }
 
 void PluginProcessor::processNoteOff(int noteNumber, int samplePosition, 
                                      juce::MidiBuffer& outputBuffer)
 {
-    // Get the generated notes for this input note
-    int mappedNote = scaleMapper_.mapNote(noteNumber);
-    auto chord = chordVoicer_.makeChordFromNote(mappedNote);
+    juce::ignoreUnused(outputBuffer);  // note events go through outputStage_
 
-    // Send note-offs for all generated notes
-    for (int note : chord)
-    {
-        juce::MidiMessage m = juce::MidiMessage::noteOff(
-            midiOutputChannel_ + 1,
-            note,
-            static_cast<juce::uint8>(0));
-        outputBuffer.addEvent(m, samplePosition);
-    }
+    // Pending gates for this key belonged to the press that just ended
+    ++pressGeneration_[noteNumber & 127];
+
+    releaseGeneratedNotes(noteNumber, samplePosition);
 
     // Track note off
-    noteTracker_.noteOff(noteNumber);
+    noteTracker_.trackNoteOff(noteNumber, samplePosition);
+}
+
+void PluginProcessor::releaseGeneratedNotes(int noteNumber, int samplePosition)
+{
+    // Get the generated notes for this input note
+    if (const ChordBuffer* chord = noteTracker_.getGeneratedNotes(noteNumber))
+    {
+        // Release this note's holds; the output stage only sends the note-off
+        // once the last holder lets go (stolen pitches were already turned off)
+        for (int note : *chord)
+        {
+            if (outputStage_.noteOff(midiOutputChannel_, note, samplePosition))
+            {
+                const int voice = voiceAllocator_.getVoiceForNote(note);
+                envelopes_.noteOff(voice);
+                modulation_.stopVoice(voice);  // no pressure for a note that is off
+                voiceAllocator_.noteOff(note);
+            }
+        }
+    }
+}
 
-    // Envelope release
-    envelope_.noteOff();
+void PluginProcessor::processScheduledEvent(const ScheduledMidiEvent& e, int samplePosition,
+                                            juce::MidiBuffer& outputBuffer)
+{
+    if (e.isNoteOff())
+    {
+        // A gate only ends the press that scheduled it
+        if (e.tag == pressGeneration_[e.data1 & 127] && noteTracker_.isNotePlaying(e.data1))
+            processNoteOff(e.data1, samplePosition, outputBuffer);
+    }
+    else if ((e.status & 0xF0) == 0x90)
+    {
+        processNoteOn(e.data1, e.data2, samplePosition, outputBuffer);
+    }
 }
 
 void PluginProcessor::processControlChange(int controller, int value, int samplePosition, 
@@ -185,10 +346,20 @@ void PluginProcessor::processControlChange(int controller, int value, int sample
             break;
         case 120: // All Sounds Off
             noteTracker_.reset();
-            envelope_.reset();
+            voiceAllocator_.reset();
+            outputStage_.allNotesOff(samplePosition);
+            envelopes_.reset();
+            modulation_.reset();
             break;
         case 123: // All Notes Off
             noteTracker_.allNotesOff();
+            for (int voice = 0; voice < EnvelopeBank::MAX_VOICES; ++voice)
+            {
+                envelopes_.noteOff(voice);
+                modulation_.stopVoice(voice);
+            }
+            voiceAllocator_.reset();
+            outputStage_.allNotesOff(samplePosition);
             break;
         default:
             // Pass through unmapped CCs
@@ -413,6 +584,7 @@ void PluginProcessor::loadPreset(const Preset& preset)
     releaseMs_ = preset.envelopeSettings.release;
     
     humanizationAmount_ = preset.envelopeSettings.humanizeAmount;
+    randomSeed_ = preset.midiEffects.randomSeed;
 
     isDirty_ = true;
     updateSettings();
@@ -435,6 +607,7 @@ void PluginProcessor::saveCurrentAsPreset(const std::string& name, const std::st
     preset.envelopeSettings.sustain = sustainLevel_;
     preset.envelopeSettings.release = releaseMs_;
     preset.envelopeSettings.humanizeAmount = humanizationAmount_;
+    preset.midiEffects.randomSeed = randomSeed_;
 
     presetManager_.addPreset(preset);
 }
@@ -453,6 +626,7 @@ Preset PluginProcessor::getCurrentPreset() const
     current.envelopeSettings.sustain = sustainLevel_;
     current.envelopeSettings.release = releaseMs_;
     current.envelopeSettings.humanizeAmount = humanizationAmount_;
+    current.midiEffects.randomSeed = randomSeed_;
 
     return current;
 }
@@ -473,6 +647,12 @@ void PluginProcessor::setChordMemoryEnabled(bool enabled) { chordMemoryEnabled_
 void PluginProcessor::setMidiInputChannel(int channel) { midiInputChannel_ = juce::jlimit(0, 16, channel); isDirty_ = true; }
 void PluginProcessor::setMidiOutputChannel(int channel) { midiOutputChannel_ = juce::jlimit(0, 15, channel); isDirty_ = true; }
 void PluginProcessor::setHumanizationAmount(float amount) { humanizationAmount_ = juce::jlimit(0.0f, 0.2f, amount); isDirty_ = true; }
+void PluginProcessor::setAutoFollowKey(bool enabled)
+{
+    // Start from a clean history, but let the audio thread do the reset
+    if (enabled) keyTrackerResetPending_.store(true, std::memory_order_release);
+    autoFollowKey_.store(enabled, std::memory_order_relaxed);
+}
 
 // ============================================================================
 // Monitoring/Analysis
@@ -497,6 +677,13 @@ std::vector<int> PluginProcessor::getSuggestedChords() const
 // Private Methods
 // ============================================================================
 
+void PluginProcessor::timerCallback()
+{
+    // Message thread: the cache build allocates, so it never runs in processBlock
+    if (voicingCacheStale_.exchange(false, std::memory_order_acquire))
+        chordVoicer_.buildChordCache();
+}
+
 void PluginProcessor::updateSettings()
 {
     if (!isDirty_) return;
@@ -507,13 +694,19 @@ void PluginProcessor::updateSettings()
     mapperSettings.scaleType = static_cast<ScaleType>(scaleType_);
     scaleMapper_.setSettings(mapperSettings);
 
-    // Update ChordVoicer
+    // Update ChordVoicer (rebuilds the voicing cache against the new mapper
+    // table here, rather than on the next note-on)
     ChordVoicer::VoicerSettings voicerSettings;
     voicerSettings.voicingType = static_cast<VoicingType>(voicingType_);
     chordVoicer_.setSettings(voicerSettings);
 
-    // Update Envelope
-    envelope_.setADSR(attackMs_, decayMs_, sustainLevel_, releaseMs_);
+    // Update Envelopes
+    EnvelopeSettings envelopeSettings = envelopes_.getSettings();
+    envelopeSettings.attack = attackMs_;
+    envelopeSettings.decay = decayMs_;
+    envelopeSettings.sustain = sustainLevel_;
+    envelopeSettings.release = releaseMs_;
+    envelopes_.setSettings(envelopeSettings);
 
     // Update MIDI Effects
     MIDIEffects::Settings effectsSettings;
@@ -6,16 +6,24 @@
 #error "This module requires JUCE. Ensure JUCE is properly integrated before building."
 #endif
 
+#include <array>
+#include <atomic>
 #include "../include/ScaleMapper.h"
 #include "../include/ChordVoicer.h"
-#include "../include/Envelope.h"
+#include "../include/EnvelopeBank.h"
+#include "../include/ModulationOutput.h"
 #include "../include/NoteTracker.h"
 #include "../include/MIDIEffects.h"
 #include "../include/ChordAnalyzer.h"
 #include "../include/VoiceLeading.h"
 #include "../include/JazzReharmonizer.h"
+#include "../include/ProgressionReharmonizer.h"
 #include "../include/PresetManager.h"
 #include "../include/PerformanceDashboard.h"
+#include "../include/KeyTracker.h"
+#include "../include/VoiceAllocator.h"
+#include "../include/MidiOutputStage.h"
+#include "../include/EventScheduler.h"
 
 namespace scalechord {
 
@@ -33,7 +41,8 @@ namespace scalechord {
  * - Real-time performance monitoring
  * - Full APVTS support for automation
  */
-class PluginProcessor : public juce::AudioProcessor
+class PluginProcessor : public juce::AudioProcessor,
+                        private juce::Timer
 {
 public:
     // Constructor & Destructor
@@ -109,6 +118,7 @@ public:
     void setMidiInputChannel(int channel);
     void setMidiOutputChannel(int channel);
     void setHumanizationAmount(float amount);
+    void setAutoFollowKey(bool enabled);
 
     // Monitoring/Analysis
     int getActiveVoiceCount() const;
@@ -119,14 +129,21 @@ private:
     // ============ Core Processing Modules ============
     ScaleMapper scaleMapper_;
     ChordVoicer chordVoicer_;
-    Envelope envelope_;
+    EnvelopeBank envelopes_;            // one envelope per allocated voice
+    ModulationOutput modulation_;       // envelopes rendered as CC/aftertouch
     NoteTracker noteTracker_;
     MIDIEffects midiEffects_;
     ChordAnalyzer chordAnalyzer_;
     VoiceLeading voiceLeading_;
+    ChordBuffer lastVoicing_;           // previous voiced chord, source for voice leading
     JazzReharmonizer jazzReharmonizer_;
+    ProgressionReharmonizer reharmonizer_;  // real-time, context-aware substitutions
     PresetManager presetManager_;
     PerformanceDashboard dashboard_;
+    KeyTracker keyTracker_;
+    VoiceAllocator voiceAllocator_;     // caps generated notes at PerformanceDashboard::MAX_VOICES
+    MidiOutputStage outputStage_;       // refcounted note-on/off per (channel, pitch)
+    EventScheduler scheduler_;          // events due in future blocks (gates, delays)
 
     // ============ APVTS (AudioProcessorValueTreeState) ============
     juce::AudioProcessorValueTreeState apvts_;
@@ -147,8 +164,10 @@ private:
     // MIDI Effects Parameters (4)
     bool legatoEnabled_ = false;
     bool chordMemoryEnabled_ = false;
-    int noteDuration_ = 0;       // 0 = infinite, > 0 = duration
+    int noteDuration_ = 0;       // 0 = infinite, > 0 = duration in ms
     float humanizationAmount_ = 0.05f; // 0.0-0.2
+    std::atomic<bool> autoFollowKey_{false};  // retarget root/scale to the detected key
+    int randomSeed_ = 0;               // preset seed for effect randomness, 0 = per instance (round-tripped only)
 
     // ============ MIDI Routing ============
     int midiInputChannel_ = 0;   // 0 = All channels, 1-16 = specific
@@ -161,11 +180,19 @@ private:
     std::string lastRecognizedChord_;
     std::vector<int> suggestedChords_;
     bool isDirty_ = true;
+    bool wasPlaying_ = false;
+    std::atomic<bool> voicingCacheStale_{false};  // set by auto-follow, cleared by timerCallback()
+    std::atomic<bool> keyTrackerResetPending_{false}; // set by setAutoFollowKey(), served on the audio thread
+    int64_t blockStartTime_ = 0;                  // scheduler time of the current block's sample 0
+    std::array<uint32_t, 128> pressGeneration_{}; // per input key, bumped on each note-on/off; tags gates
 
     // ============ Private Methods ============
     void updateSettings();
+    void timerCallback() override;
     void processNoteOn(int noteNumber, int velocity, int samplePosition, juce::MidiBuffer& outputBuffer);
     void processNoteOff(int noteNumber, int samplePosition, juce::MidiBuffer& outputBuffer);
+    void releaseGeneratedNotes(int noteNumber, int samplePosition);  // drop one input note's output holds
+    void processScheduledEvent(const ScheduledMidiEvent& e, int samplePosition, juce::MidiBuffer& outputBuffer);
     void processControlChange(int controller, int value, int samplePosition, juce::MidiBuffer& outputBuffer);
     void analyzeAndSuggest(int noteNumber);
 
@@ -5,42 +5,31 @@
 
 ChordAnalyzer::ChordAnalyzer() = default;
 
-std::vector<int> ChordAnalyzer::normalizePitchClasses(
+scalechord::PitchClassSet ChordAnalyzer::normalizePitchClasses(
     const std::vector<int>& notes, int baseKey) const
 {
-    if (notes.empty()) return {};
-
-    std::vector<int> normalized;
-    for (int note : notes) {
-        int pitchClass = (note - baseKey + 12) % 12;
-        normalized.push_back(pitchClass);
-    }
-
-    // Sort and deduplicate
-    std::sort(normalized.begin(), normalized.end());
-    normalized.erase(std::unique(normalized.begin(), normalized.end()), normalized.end());
-
-    return normalized;
+    return scalechord::PitchClassSet::fromNotes(notes, baseKey);
 }
 
 float ChordAnalyzer::matchPatternScore(
-    const std::vector<int>& normalized,
-    const ChordPattern& pattern) const
+    scalechord::PitchClassSet normalized,
+    const ChordPattern& pattern)
 {
-    // Must have at least the pattern notes
-    if (normalized.size() < pattern.numNotes) {
-        return 0.0f;
+    scalechord::PitchClassSet patternSet;
+    int highest = 0;
+    for (int i = 0; i < pattern.numNotes; ++i) {
+        patternSet.insert(pattern.intervals[i]);
+        highest = std::max(highest, pattern.intervals[i]);
     }
 
-    // Check if all intervals in pattern match normalized
-    for (int i = 0; i < pattern.numNotes; ++i) {
-        if (normalized[i] != pattern.intervals[i]) {
-            return 0.0f;  // Not a match
-        }
+    // Everything up to the pattern's highest interval must match exactly
+    uint16_t below = static_cast<uint16_t>((2u << highest) - 1);
+    if ((normalized.mask() & below) != patternSet.mask()) {
+        return 0.0f;  // Not a match
     }
     
     // If pattern size matches exactly, return full confidence
-    if (normalized.size() == pattern.numNotes) {
+    if (normalized == patternSet) {
         return pattern.confidence;
     }
     
@@ -50,45 +39,102 @@ float ChordAnalyzer::matchPatternScore(
     return confidence;
 }
 
-ChordInfo ChordAnalyzer::analyzeChord(
-    const std::vector<int>& notes, int baseKey) const
+std::array<ChordAnalyzer::ChordTableEntry, 4096> ChordAnalyzer::buildChordTable()
 {
-    ChordInfo result;
+    std::array<ChordTableEntry, 4096> entries{};
 
-    if (notes.empty()) {
-        result.quality = ChordQuality::Unknown;
-        result.confidence = 0.0f;
-        return result;
+    // Root-position match for every mask
+    for (int mask = 0; mask < 4096; ++mask) {
+        scalechord::PitchClassSet set(static_cast<uint16_t>(mask));
+        ChordTableEntry& entry = entries[mask];
+        entry.rootQuality = ChordQuality::Unknown;
+        entry.rootConfidence = 0.0f;
+        for (const auto& pattern : CHORD_PATTERNS) {
+            float score = matchPatternScore(set, pattern);
+            if (score > entry.rootConfidence) {
+                entry.rootConfidence = score;
+                entry.rootQuality = pattern.quality;
+            }
+        }
     }
 
-    // Use lowest note as root
-    result.root = *std::min_element(notes.begin(), notes.end());
+    // Best root: try every chord tone, lowest pitch class wins ties
+    for (int mask = 0; mask < 4096; ++mask) {
+        scalechord::PitchClassSet set(static_cast<uint16_t>(mask));
+        ChordTableEntry& entry = entries[mask];
+        entry.bestQuality = ChordQuality::Unknown;
+        entry.bestConfidence = 0.0f;
+        entry.bestRoot = 0;
+        for (int root : set) {
+            const ChordTableEntry& rotated = entries[set.rotate(-root).mask()];
+            if (rotated.rootConfidence > entry.bestConfidence) {
+                entry.bestConfidence = rotated.rootConfidence;
+                entry.bestQuality = rotated.rootQuality;
+                entry.bestRoot = static_cast<uint8_t>(root);
+            }
+        }
+    }
+    return entries;
+}
+
+// 4096 masks x 16 patterns takes about a millisecond, so it is built during
+// static initialization rather than on the first (audio-thread) analysis;
+// after that every analysis is a lookup instead of a pattern scan per root
+const std::array<ChordAnalyzer::ChordTableEntry, 4096> ChordAnalyzer::chordTable_ =
+    ChordAnalyzer::buildChordTable();
 
-    // Normalize to pitch classes from root
-    std::vector<int> normalized = normalizePitchClasses(notes, result.root);
+ChordMatch ChordAnalyzer::matchPitchClasses(scalechord::PitchClassSet pitchClasses)
+{
+    const ChordTableEntry& entry = chordTable_[pitchClasses.mask()];
+    return {entry.bestQuality, entry.bestRoot, entry.bestConfidence};
+}
+
+ChordMatch ChordAnalyzer::matchRootPosition(scalechord::PitchClassSet pitchClasses)
+{
+    const ChordTableEntry& entry = chordTable_[pitchClasses.mask()];
+    return {entry.rootQuality, 0, entry.rootConfidence};
+}
 
-    // Try to match against chord patterns
-    float bestScore = 0.0f;
-    int bestPattern = -1;
+namespace {
 
-    for (int i = 0; i < static_cast<int>(CHORD_PATTERNS.size()); ++i) {
-        float score = matchPatternScore(normalized, CHORD_PATTERNS[i]);
-        if (score > bestScore) {
-            bestScore = score;
-            bestPattern = i;
+// Lowest MIDI note of the chord with the given pitch class (relative to bass)
+int lowestNoteWithPitchClass(const std::vector<int>& notes, int bass, int pitchClass)
+{
+    int best = bass;
+    bool found = false;
+    for (int note : notes) {
+        if (scalechord::PitchClassSet::wrap(note - bass) == pitchClass && (!found || note < best)) {
+            best = note;
+            found = true;
         }
     }
+    return best;
+}
 
-    if (bestPattern >= 0) {
-        result.quality = CHORD_PATTERNS[bestPattern].quality;
-        result.confidence = bestScore;
-        result.intervals = normalized;
-    } else {
+} // namespace
+
+ChordInfo ChordAnalyzer::analyzeChord(
+    const std::vector<int>& notes, int baseKey) const
+{
+    ChordInfo result;
+
+    if (notes.empty()) {
         result.quality = ChordQuality::Unknown;
         result.confidence = 0.0f;
-        result.intervals = normalized;
+        return result;
     }
 
+    // Pitch classes relative to the lowest note
+    int bass = *std::min_element(notes.begin(), notes.end());
+    scalechord::PitchClassSet normalized = normalizePitchClasses(notes, bass);
+
+    // One lookup covers root position and every inversion
+    ChordMatch match = matchPitchClasses(normalized);
+    result.quality = match.quality;
+    result.confidence = match.confidence;
+    result.root = lowestNoteWithPitchClass(notes, bass, match.rootOffset);
+    result.intervals = normalized.rotate(-match.rootOffset).toVector();
+
     // Determine function based on root in key
     result.function = detectFunction(result.root % 12, baseKey, true);
 
@@ -102,19 +148,29 @@ std::vector<ChordInfo> ChordAnalyzer::analyzeChordAmbiguous(
 
     if (notes.empty()) return results;
 
-    // Try each note as potential root
-    for (int rootNote : notes) {
-        ChordInfo info = analyzeChord(notes, rootNote);
-        if (info.confidence > 0.5f) {  // Only include confident interpretations
+    int bass = *std::min_element(notes.begin(), notes.end());
+    scalechord::PitchClassSet normalized = normalizePitchClasses(notes, bass);
+
+    // Try each chord tone as potential root (bass first)
+    for (int rootOffset : normalized) {
+        scalechord::PitchClassSet fromRoot = normalized.rotate(-rootOffset);
+        ChordMatch match = matchRootPosition(fromRoot);
+        if (match.confidence > 0.5f) {  // Only include confident interpretations
+            ChordInfo info;
+            info.root = lowestNoteWithPitchClass(notes, bass, rootOffset);
+            info.quality = match.quality;
+            info.confidence = match.confidence;
+            info.intervals = fromRoot.toVector();
+            info.function = detectFunction(info.root % 12, baseKey, true);
             results.push_back(info);
         }
     }
 
     // Sort by confidence (highest first)
-    std::sort(results.begin(), results.end(),
-              [](const ChordInfo& a, const ChordInfo& b) {
-                  return a.confidence > b.confidence;
-              });
+    std::stable_sort(results.begin(), results.end(),
+                     [](const ChordInfo& a, const ChordInfo& b) {
+                         return a.confidence > b.confidence;
+                     });
 
     return results;
 }
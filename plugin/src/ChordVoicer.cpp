@@ -1,48 +1,67 @@
 #include "ChordVoicer.h"
+#include "ScaleTables.h"
 #include <algorithm>
 
 namespace scalechord {
 
-ChordVoicer::ChordVoicer(const ScaleMapper& mapper) : mapper_(mapper) {}
+ChordVoicer::ChordVoicer(const ScaleMapper& mapper) : mapper_(mapper) {
+    buildChordCache();
+}
 
-void ChordVoicer::setSettings(const VoicerSettings& s) { settings_ = s; }
-VoicerSettings ChordVoicer::getSettings() const noexcept { return settings_; }
+void ChordVoicer::setSettings(const VoicerSettings& s) {
+    settings_ = s;
+    buildChordCache();
+}
+
+VoicerSettings ChordVoicer::getSettings() const noexcept {
+    auto snapshot = snapshot_.read();
+    return snapshot->settings;
+}
 
 std::vector<int> ChordVoicer::makeChordFromNote(int baseMappedMidiNote) const {
+    ChordBuffer chord;
+    makeChordInto(baseMappedMidiNote, chord);
+    return chord.toVector();
+}
+
+void ChordVoicer::makeChordInto(int baseMappedMidiNote, ChordBuffer& chord) const {
+    auto snapshot = snapshot_.read();
+    voiceChord(mapper_.getScaleTable(), snapshot->settings, baseMappedMidiNote, chord);
+}
+
+void ChordVoicer::voiceChord(const ScaleTable& table, const VoicerSettings& settings,
+                             int baseMappedMidiNote, ChordBuffer& chord) {
     // We'll use scale degrees to find chord tones. This simplified approach assumes
     // baseMappedMidiNote is within the selected scale. We'll construct chords by
     // moving up scale degrees (3rd and 5th, etc.).
+    chord.clear();
 
-    // get semitones of scale relative to root (0..11)
-    auto scaleSemis = mapper_.getScaleSemitones();
-
-    if (scaleSemis.empty()) return {};
+    // semitones of scale relative to root (0..11), from the static scale tables
+    const auto& scaleSemis = table.semitones;
+    const int numDegrees = table.size;
 
     int baseOctave = baseMappedMidiNote / 12;
     int basePitchClass = baseMappedMidiNote % 12;
 
-    // find index of basePitchClass in scaleSemis (best match)
-    int baseIndex = 0;
-    for (size_t i = 0; i < scaleSemis.size(); ++i) {
-        if (scaleSemis[i] == basePitchClass) { baseIndex = static_cast<int>(i); break; }
-    }
+    // index of basePitchClass in the scale (root of scale if not found)
+    int baseIndex = basePitchClass >= 0 ? table.degreeOf[basePitchClass] : -1;
+    if (baseIndex < 0) baseIndex = 0;
 
-    std::vector<int> chord;
     auto pushDegree = [&](int degreeStep) {
         // degreeStep: 0=root, 1=next scale degree, etc.
-        int degreeIndex = (baseIndex + degreeStep) % scaleSemis.size();
-        int octaveShift = (baseIndex + degreeStep) / static_cast<int>(scaleSemis.size());
-        int midi = (baseOctave + octaveShift + settings_.octaveOffset) * 12 + scaleSemis[degreeIndex];
+        int degreeIndex = (baseIndex + degreeStep) % numDegrees;
+        int octaveShift = (baseIndex + degreeStep) / numDegrees;
+        int midi = (baseOctave + octaveShift + settings.octaveOffset) * 12 + scaleSemis[degreeIndex];
         if (midi < 0) midi = 0;
         if (midi > 127) midi = 127;
         chord.push_back(midi);
     };
 
-    if (settings_.voicing == VoicingType::Triad) {
+    if (settings.voicing == VoicingType::Triad) {
         pushDegree(0);
         pushDegree(2);
         pushDegree(4);
-    } else if (settings_.voicing == VoicingType::Seventh) {
+    } else if (settings.voicing == VoicingType::Seventh) {
         pushDegree(0);
         pushDegree(2);
         pushDegree(4);
@@ -51,14 +70,42 @@ std::vector<int> ChordVoicer::makeChordFromNote(int baseMappedMidiNote) const {
         pushDegree(0);
         pushDegree(2);
         // spread the 5th an octave up
-        int degreeIndex = (baseIndex + 4) % scaleSemis.size();
-        int octaveShift = ((baseIndex + 4) / static_cast<int>(scaleSemis.size())) + 1;
-        int midi = (baseOctave + octaveShift + settings_.octaveOffset) * 12 + scaleSemis[degreeIndex];
+        int degreeIndex = (baseIndex + 4) % numDegrees;
+        int octaveShift = ((baseIndex + 4) / numDegrees) + 1;
+        int midi = (baseOctave + octaveShift + settings.octaveOffset) * 12 + scaleSemis[degreeIndex];
         chord.push_back(midi);
     }
 
     std::sort(chord.begin(), chord.end());
-    return chord;
+}
+
+void ChordVoicer::buildChordCache() {
+    // Built here on the message thread, then published in one atomic swap
+    auto next = std::make_unique<VoicingSnapshot>();
+    next->settings = settings_;
+    next->table = &mapper_.getScaleTable();
+    for (int note = 0; note < 128; ++note) {
+        voiceChord(*next->table, next->settings, note, next->chords[note]);
+    }
+    snapshot_.publish(std::move(next));
+}
+
+ChordBuffer ChordVoicer::getCachedChord(int baseMappedMidiNote) const {
+    if (baseMappedMidiNote < 0) baseMappedMidiNote = 0;
+    if (baseMappedMidiNote > 127) baseMappedMidiNote = 127;
+
+    auto snapshot = snapshot_.read();
+    const ScaleTable& table = mapper_.getScaleTable();
+
+    // The mapper's table pointer identifies its scale/root; if it moved on since
+    // the snapshot was built, voice directly rather than returning a stale chord
+    if (snapshot->table != &table) {
+        ChordBuffer chord;
+        voiceChord(table, snapshot->settings, baseMappedMidiNote, chord);
+        return chord;
+    }
+
+    return snapshot->chords[baseMappedMidiNote];
 }
 
 } // namespace scalechord
@@ -1,13 +1,8 @@
 // ADSR Envelope implementation
 #include "Envelope.h"
-#include <random>
-#include <ctime>
 
 namespace scalechord {
 
-static std::mt19937 g_rng(static_cast<unsigned>(std::time(nullptr)));
-static std::uniform_real_distribution<float> g_distribution(-1.0f, 1.0f);
-
 Envelope::Envelope(const EnvelopeSettings& s) : settings_(s) {
     updateIncrements();
 }
@@ -82,7 +77,7 @@ float Envelope::process() {
     
     float humanizationFactor = 1.0f;
     if (settings_.humanize) {
-        humanizationFactor = 1.0f + g_distribution(g_rng) * settings_.humanizeAmount;
+        humanizationFactor = 1.0f + rng_.nextBipolar() * settings_.humanizeAmount;
     }
     
     switch (state_) {
@@ -129,4 +124,109 @@ float Envelope::process() {
     return std::clamp(currentAmplitude_, 0.0f, 1.0f);
 }
 
+// ============================================================================
+// ExponentialEnvelope
+// ============================================================================
+
+ExponentialEnvelope::ExponentialEnvelope(const EnvelopeSettings& s) : settings_(s) {
+    updateIncrements();
+}
+
+void ExponentialEnvelope::setSettings(const EnvelopeSettings& s) {
+    settings_ = s;
+    updateIncrements();
+}
+
+void ExponentialEnvelope::setSampleRate(float sampleRate) {
+    if (sampleRate <= 0.0f) return;
+    sampleRate_ = sampleRate;
+    updateIncrements();
+}
+
+void ExponentialEnvelope::noteOn(int velocity, float sampleRate) {
+    if (sampleRate > 0.0f) sampleRate_ = sampleRate;
+
+    peak_ = 1.0f;
+    if (settings_.velocitySensitivity > 0.0f) {
+        float velocityFactor = static_cast<float>(velocity) / 127.0f;
+        peak_ *= (1.0f - settings_.velocitySensitivity) + settings_.velocitySensitivity * velocityFactor;
+    }
+
+    // One draw per note instead of one per sample
+    humanizeOffset_ = settings_.humanize ? rng_.nextBipolar() * settings_.humanizeAmount : 0.0f;
+
+    updateIncrements();
+    state_ = EnvelopeState::Attack;  // retriggers from the current level
+}
+
+void ExponentialEnvelope::noteOff() {
+    if (state_ == EnvelopeState::Idle || state_ == EnvelopeState::Release) return;
+    state_ = EnvelopeState::Release;
+    // Release aims just below zero from wherever the note was let go
+    releaseOffset_ = -DECAY_RATIO * level_ * (1.0f - releaseCoef_);
+}
+
+float ExponentialEnvelope::segmentCoef(float ms, float ratio) const {
+    // Reaches the segment end in `samples` steps when aiming `ratio` of the span past it
+    float samples = std::max(1.0f, ms * sampleRate_ / 1000.0f);
+    return std::exp(-std::log((1.0f + ratio) / ratio) / samples);
+}
+
+void ExponentialEnvelope::updateIncrements() {
+    if (sampleRate_ <= 0) return;
+
+    sustainLevel_ = settings_.sustain * peak_;
+
+    // Humanization scales the attack rate, as in Envelope
+    attackCoef_ = segmentCoef(settings_.attack / (1.0f + humanizeOffset_), ATTACK_RATIO);
+    attackOffset_ = peak_ * (1.0f + ATTACK_RATIO) * (1.0f - attackCoef_);
+
+    decayCoef_ = segmentCoef(settings_.decay, DECAY_RATIO);
+    decayOffset_ = (sustainLevel_ - DECAY_RATIO * (peak_ - sustainLevel_)) * (1.0f - decayCoef_);
+
+    releaseCoef_ = segmentCoef(settings_.release, DECAY_RATIO);
+    releaseOffset_ = -DECAY_RATIO * level_ * (1.0f - releaseCoef_);
+}
+
+float ExponentialEnvelope::process() noexcept {
+    // Tolerance so a segment rounding just short of its end still finishes
+    constexpr float EPSILON = 1e-6f;
+
+    switch (state_) {
+        case EnvelopeState::Attack:
+            level_ = level_ * attackCoef_ + attackOffset_;
+            if (level_ >= peak_ - EPSILON) {
+                level_ = peak_;
+                state_ = EnvelopeState::Decay;
+            }
+            break;
+
+        case EnvelopeState::Decay:
+            level_ = level_ * decayCoef_ + decayOffset_;
+            if (level_ <= sustainLevel_ + EPSILON) {
+                level_ = sustainLevel_;
+                state_ = EnvelopeState::Sustain;
+            }
+            break;
+
+        case EnvelopeState::Sustain:
+            break;
+
+        case EnvelopeState::Release:
+            level_ = level_ * releaseCoef_ + releaseOffset_;
+            if (level_ <= EPSILON) {
+                level_ = 0.0f;
+                state_ = EnvelopeState::Idle;
+            }
+            break;
+
+        case EnvelopeState::Idle:
+        default:
+            level_ = 0.0f;
+            break;
+    }
+
+    return std::clamp(level_, 0.0f, 1.0f);
+}
+
 } // namespace scalechord
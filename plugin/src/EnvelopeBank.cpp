@@ -0,0 +1,189 @@
+#include "EnvelopeBank.h"
+#include <limits>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace scalechord {
+
+namespace {
+
+constexpr float FOREVER = std::numeric_limits<float>::infinity();
+
+inline int ctz64(uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1u)) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+} // namespace
+
+EnvelopeBank::EnvelopeBank() {
+    reset();
+}
+
+EnvelopeBank::EnvelopeBank(const EnvelopeSettings& s) : settings_(s) {
+    reset();
+}
+
+void EnvelopeBank::setSettings(const EnvelopeSettings& s) {
+    settings_ = s;
+}
+
+void EnvelopeBank::setSampleRate(float sampleRate) noexcept {
+    if (sampleRate > 0.0f) sampleRate_ = sampleRate;
+}
+
+void EnvelopeBank::noteOn(int voice, int velocity) noexcept {
+    if (voice < 0 || voice >= MAX_VOICES) return;
+
+    // Velocity sensitivity, as in Envelope::noteOn
+    float peak = 1.0f;
+    if (settings_.velocitySensitivity > 0.0f) {
+        float velocityFactor = static_cast<float>(std::max(0, std::min(127, velocity))) / 127.0f;
+        peak = (1.0f - settings_.velocitySensitivity) + settings_.velocitySensitivity * velocityFactor;
+    }
+    peak_[voice] = peak;
+    enterStage(voice, EnvelopeState::Attack);
+}
+
+void EnvelopeBank::noteOff(int voice) noexcept {
+    if (voice < 0 || voice >= MAX_VOICES) return;
+    if (state_[voice] != EnvelopeState::Idle && state_[voice] != EnvelopeState::Release) {
+        enterStage(voice, EnvelopeState::Release);
+    }
+}
+
+void EnvelopeBank::process(int numSamples) noexcept {
+    if (numSamples <= 0) return;
+    todo_.fill(static_cast<float>(numSamples));
+
+    // Each pass moves every voice to the end of its segment or of the block;
+    // only voices whose segment ended need a (scalar) stage change and another pass
+    for (uint64_t ended = advanceLanes(); ended; ended = advanceLanes()) {
+        do {
+            const int v = ctz64(ended);
+            ended &= ended - 1;
+            level_[v] = target_[v];  // snap, no accumulated drift
+            switch (state_[v]) {
+                case EnvelopeState::Attack:  enterStage(v, EnvelopeState::Decay); break;
+                case EnvelopeState::Decay:   enterStage(v, EnvelopeState::Sustain); break;
+                case EnvelopeState::Release: enterStage(v, EnvelopeState::Idle); break;
+                default: break;
+            }
+        } while (ended);
+    }
+}
+
+float EnvelopeBank::getLevel(int voice) const noexcept {
+    return (voice >= 0 && voice < MAX_VOICES) ? std::clamp(level_[voice], 0.0f, 1.0f) : 0.0f;
+}
+
+EnvelopeState EnvelopeBank::getState(int voice) const noexcept {
+    return (voice >= 0 && voice < MAX_VOICES) ? state_[voice] : EnvelopeState::Idle;
+}
+
+int EnvelopeBank::getActiveCount() const noexcept {
+    int count = 0;
+    for (EnvelopeState s : state_) count += s != EnvelopeState::Idle;
+    return count;
+}
+
+void EnvelopeBank::reset() noexcept {
+    level_.fill(0.0f);
+    increment_.fill(0.0f);
+    remaining_.fill(FOREVER);
+    target_.fill(0.0f);
+    peak_.fill(1.0f);
+    todo_.fill(0.0f);
+    state_.fill(EnvelopeState::Idle);
+}
+
+float EnvelopeBank::segmentSamples(float ms) const noexcept {
+    return std::max(1.0f, std::round(ms * sampleRate_ / 1000.0f));
+}
+
+void EnvelopeBank::enterStage(int voice, EnvelopeState stage) noexcept {
+    const float level = level_[voice];
+    float target = 0.0f;
+    float samples = FOREVER;
+
+    switch (stage) {
+        case EnvelopeState::Attack:
+            target = peak_[voice];
+            samples = segmentSamples(settings_.attack);
+            break;
+        case EnvelopeState::Decay:
+            target = settings_.sustain * peak_[voice];
+            samples = segmentSamples(settings_.decay);
+            break;
+        case EnvelopeState::Release:
+            if (level <= 0.0f) {
+                enterStage(voice, EnvelopeState::Idle);
+                return;
+            }
+            samples = segmentSamples(settings_.release);
+            break;
+        case EnvelopeState::Sustain:
+            level_[voice] = settings_.sustain * peak_[voice];
+            target = level_[voice];
+            break;
+        case EnvelopeState::Idle:
+        default:
+            level_[voice] = 0.0f;
+            break;
+    }
+
+    state_[voice] = stage;
+    target_[voice] = target;
+    remaining_[voice] = samples;
+    increment_[voice] = samples == FOREVER ? 0.0f : (target - level) / samples;
+}
+
+uint64_t EnvelopeBank::advanceLanes() noexcept {
+    uint64_t ended = 0;
+#if defined(__AVX__)
+    const __m256 zero = _mm256_setzero_ps();
+    for (int v = 0; v < MAX_VOICES; v += 8) {
+        __m256 remaining = _mm256_load_ps(&remaining_[v]);
+        __m256 todo = _mm256_load_ps(&todo_[v]);
+        __m256 step = _mm256_min_ps(todo, remaining);
+        __m256 level = _mm256_add_ps(_mm256_load_ps(&level_[v]),
+                                     _mm256_mul_ps(step, _mm256_load_ps(&increment_[v])));
+        remaining = _mm256_sub_ps(remaining, step);
+        _mm256_store_ps(&level_[v], level);
+        _mm256_store_ps(&remaining_[v], remaining);
+        _mm256_store_ps(&todo_[v], _mm256_sub_ps(todo, step));
+        ended |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_cmp_ps(remaining, zero, _CMP_LE_OQ))) << v;
+    }
+#elif defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    for (int v = 0; v < MAX_VOICES; v += 4) {
+        __m128 remaining = _mm_load_ps(&remaining_[v]);
+        __m128 todo = _mm_load_ps(&todo_[v]);
+        __m128 step = _mm_min_ps(todo, remaining);
+        __m128 level = _mm_add_ps(_mm_load_ps(&level_[v]), _mm_mul_ps(step, _mm_load_ps(&increment_[v])));
+        remaining = _mm_sub_ps(remaining, step);
+        _mm_store_ps(&level_[v], level);
+        _mm_store_ps(&remaining_[v], remaining);
+        _mm_store_ps(&todo_[v], _mm_sub_ps(todo, step));
+        ended |= static_cast<uint64_t>(_mm_movemask_ps(_mm_cmple_ps(remaining, zero))) << v;
+    }
+#else
+    for (int v = 0; v < MAX_VOICES; ++v) {
+        const float step = std::min(todo_[v], remaining_[v]);
+        level_[v] += step * increment_[v];
+        remaining_[v] -= step;
+        todo_[v] -= step;
+        if (remaining_[v] <= 0.0f) ended |= uint64_t(1) << v;
+    }
+#endif
+    return ended;
+}
+
+} // namespace scalechord
@@ -0,0 +1,177 @@
+#include "EventScheduler.h"
+#include <cmath>
+
+namespace scalechord {
+
+namespace {
+
+inline int ctz64(uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1u)) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+constexpr int LEVEL1_SHIFT = 10;
+constexpr int LEVEL2_SHIFT = 20;
+
+} // namespace
+
+EventScheduler::EventScheduler(int capacity) {
+    nodes_.resize(static_cast<size_t>(std::max(1, capacity)));
+    clear();
+}
+
+void EventScheduler::prepare(double sampleRate, double bpm) {
+    if (sampleRate > 0.0) sampleRate_ = sampleRate;
+    if (bpm > 0.0) bpm_ = bpm;
+}
+
+void EventScheduler::setSampleRate(double sampleRate) {
+    if (sampleRate <= 0.0 || sampleRate == sampleRate_) return;
+    rescale(sampleRate / sampleRate_, false);
+    sampleRate_ = sampleRate;
+}
+
+void EventScheduler::setTempo(double bpm) {
+    if (bpm <= 0.0 || bpm == bpm_) return;
+    rescale(bpm_ / bpm, true);  // samples per beat scale inversely with tempo
+    bpm_ = bpm;
+}
+
+bool EventScheduler::scheduleAt(int64_t sampleTime, uint8_t status, uint8_t data1, uint8_t data2,
+                                uint32_t tag) noexcept {
+    ScheduledMidiEvent e;
+    e.time = sampleTime;
+    e.status = status;
+    e.data1 = data1;
+    e.data2 = data2;
+    e.tag = tag;
+    return schedule(e);
+}
+
+bool EventScheduler::scheduleAfterBeats(double beats, uint8_t status, uint8_t data1, uint8_t data2,
+                                        uint32_t tag) noexcept {
+    ScheduledMidiEvent e;
+    e.time = now_ + std::llround(std::max(0.0, beats) * 60.0 / bpm_ * sampleRate_);
+    e.status = status;
+    e.data1 = data1;
+    e.data2 = data2;
+    e.tag = tag;
+    e.tempoRelative = true;
+    return schedule(e);
+}
+
+void EventScheduler::clear() noexcept {
+    for (auto& level : heads_) level.fill(-1);
+    for (auto& level : tails_) level.fill(-1);
+    occupied_ = {};
+
+    const int32_t count = static_cast<int32_t>(nodes_.size());
+    for (int32_t i = 0; i < count; ++i) nodes_[i].next = i + 1 < count ? i + 1 : -1;
+    freeList_ = 0;
+    pending_ = 0;
+    now_ = 0;
+}
+
+bool EventScheduler::schedule(const ScheduledMidiEvent& e) noexcept {
+    if (freeList_ < 0 || e.time - now_ >= HORIZON) return false;
+
+    const int32_t n = freeList_;
+    freeList_ = nodes_[n].next;
+    nodes_[n].event = e;
+    if (nodes_[n].event.time < now_) nodes_[n].event.time = now_;
+    insert(n);
+    ++pending_;
+    return true;
+}
+
+void EventScheduler::insert(int32_t node) noexcept {
+    const int64_t t = nodes_[node].event.time;
+    int level, slot;
+    if ((t >> LEVEL1_SHIFT) == (now_ >> LEVEL1_SHIFT)) {
+        level = 0;
+        slot = static_cast<int>(t & SLOT_MASK);
+        occupied_[slot >> 6] |= uint64_t(1) << (slot & 63);
+    } else if ((t >> LEVEL1_SHIFT) - (now_ >> LEVEL1_SHIFT) < WHEEL_SIZE) {
+        level = 1;
+        slot = static_cast<int>((t >> LEVEL1_SHIFT) & SLOT_MASK);
+    } else {
+        level = 2;
+        slot = static_cast<int>((t >> LEVEL2_SHIFT) & SLOT_MASK);
+    }
+
+    nodes_[node].next = -1;
+    if (tails_[level][slot] >= 0) nodes_[tails_[level][slot]].next = node;
+    else heads_[level][slot] = node;
+    tails_[level][slot] = node;
+}
+
+int32_t EventScheduler::detach(int level, int slot) noexcept {
+    const int32_t head = heads_[level][slot];
+    heads_[level][slot] = tails_[level][slot] = -1;
+    if (level == 0) occupied_[slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+    return head;
+}
+
+void EventScheduler::release(int32_t node) noexcept {
+    nodes_[node].next = freeList_;
+    freeList_ = node;
+    --pending_;
+}
+
+void EventScheduler::cascade() noexcept {
+    // now_ has just reached a level-1 boundary; pull its slot (and, at a
+    // level-2 boundary, the level-2 slot first) down toward level 0
+    if ((now_ & ((int64_t(1) << LEVEL2_SHIFT) - 1)) == 0) {
+        for (int32_t n = detach(2, static_cast<int>((now_ >> LEVEL2_SHIFT) & SLOT_MASK)); n >= 0;) {
+            const int32_t next = nodes_[n].next;
+            insert(n);
+            n = next;
+        }
+    }
+    for (int32_t n = detach(1, static_cast<int>((now_ >> LEVEL1_SHIFT) & SLOT_MASK)); n >= 0;) {
+        const int32_t next = nodes_[n].next;
+        insert(n);
+        n = next;
+    }
+}
+
+void EventScheduler::rescale(double ratio, bool tempoRelativeOnly) noexcept {
+    // Collect every pending node into one chain, then reinsert at the new times
+    int32_t chain = -1;
+    for (int level = 0; level < LEVELS; ++level) {
+        for (int slot = 0; slot < WHEEL_SIZE; ++slot) {
+            if (heads_[level][slot] < 0) continue;
+            const int32_t tail = tails_[level][slot];
+            nodes_[tail].next = chain;
+            chain = detach(level, slot);
+        }
+    }
+
+    for (int32_t n = chain; n >= 0;) {
+        const int32_t next = nodes_[n].next;
+        ScheduledMidiEvent& e = nodes_[n].event;
+        if (!tempoRelativeOnly || e.tempoRelative) {
+            const int64_t delay = std::llround(static_cast<double>(e.time - now_) * ratio);
+            e.time = now_ + std::min(delay, HORIZON - 1);
+        }
+        insert(n);
+        n = next;
+    }
+}
+
+int EventScheduler::nextOccupied(int from, int to) const noexcept {
+    for (int w = from >> 6; w <= (to >> 6); ++w) {
+        uint64_t bits = occupied_[w];
+        if (w == (from >> 6)) bits &= ~uint64_t(0) << (from & 63);
+        if (w == (to >> 6) && (to & 63) != 63) bits &= (uint64_t(1) << ((to & 63) + 1)) - 1;
+        if (bits) return w * 64 + ctz64(bits);
+    }
+    return -1;
+}
+
+} // namespace scalechord
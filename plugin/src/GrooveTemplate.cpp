@@ -0,0 +1,226 @@
+#include "GrooveTemplate.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace scalechord {
+
+namespace {
+
+bool readFile(const std::string& filepath, std::string& outBytes) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    outBytes = buffer.str();
+    return true;
+}
+
+// Big-endian and variable-length readers over a byte string; false when out of data
+struct ByteReader {
+    const std::string& bytes;
+    size_t pos = 0;
+
+    bool has(size_t n) const { return pos + n <= bytes.size(); }
+    uint8_t peek() const { return static_cast<uint8_t>(bytes[pos]); }
+    bool u8(uint32_t& out) {
+        if (!has(1)) return false;
+        out = static_cast<uint8_t>(bytes[pos++]);
+        return true;
+    }
+    bool be(int n, uint32_t& out) {
+        if (!has(static_cast<size_t>(n))) return false;
+        out = 0;
+        for (int i = 0; i < n; ++i) out = (out << 8) | static_cast<uint8_t>(bytes[pos++]);
+        return true;
+    }
+    bool varLen(uint32_t& out) {
+        out = 0;
+        for (int i = 0; i < 4; ++i) {
+            uint32_t b;
+            if (!u8(b)) return false;
+            out = (out << 7) | (b & 0x7F);
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+};
+
+constexpr char BINARY_MAGIC[] = "GRV1";
+
+} // namespace
+
+GrooveTemplate::GrooveTemplate(int length) : length_(std::max(1, std::min(MAX_STEPS, length))) {
+    velocity_.fill(1.0f);
+}
+
+void GrooveTemplate::setStep(int step, float timingOffset, float velocityScale) noexcept {
+    const int s = wrap(step);
+    timing_[s] = std::clamp(timingOffset, -0.5f, 0.5f);
+    velocity_[s] = std::clamp(velocityScale, 0.0f, 2.55f);
+}
+
+int64_t GrooveTemplate::gridIndex(double ppq) noexcept {
+    return static_cast<int64_t>(std::floor(ppq / STEP_QN + 0.5));
+}
+
+int GrooveTemplate::applyVelocity(int velocity, double ppq, float amount) const noexcept {
+    const float scale = 1.0f + (velocity_[stepAt(ppq)] - 1.0f) * amount;
+    return std::clamp(static_cast<int>(std::lround(velocity * scale)), 1, 127);
+}
+
+double GrooveTemplate::tighten(double ppq, float strength, double maxShiftQn) const noexcept {
+    const int64_t index = gridIndex(ppq);
+    const double target = (index + timing_[wrap(index)]) * STEP_QN;
+    const double shift = (target - ppq) * std::clamp(strength, 0.0f, 1.0f);
+    return ppq + std::clamp(shift, -maxShiftQn, maxShiftQn);
+}
+
+bool GrooveTemplate::extract(const std::vector<GrooveNote>& notes, int length, GrooveTemplate& outGroove) {
+    if (notes.empty() || length < 1 || length > MAX_STEPS) return false;
+
+    std::array<double, MAX_STEPS> offsetSum{};
+    std::array<double, MAX_STEPS> velocitySum{};
+    std::array<int, MAX_STEPS> count{};
+    double totalVelocity = 0.0;
+
+    GrooveTemplate groove(length);
+    for (const GrooveNote& n : notes) {
+        const int64_t index = gridIndex(n.ppq);
+        const int step = groove.wrap(index);
+        offsetSum[step] += n.ppq / STEP_QN - static_cast<double>(index);
+        velocitySum[step] += n.velocity;
+        totalVelocity += n.velocity;
+        ++count[step];
+    }
+
+    const double meanVelocity = totalVelocity / static_cast<double>(notes.size());
+    for (int s = 0; s < length; ++s) {
+        if (count[s] == 0 || meanVelocity <= 0.0) continue;  // untouched steps stay straight
+        groove.setStep(s, static_cast<float>(offsetSum[s] / count[s]),
+                       static_cast<float>(velocitySum[s] / count[s] / meanVelocity));
+    }
+    outGroove = groove;
+    return true;
+}
+
+bool GrooveTemplate::parseMidiFile(const std::string& bytes, std::vector<GrooveNote>& outNotes) {
+    ByteReader r{bytes};
+    uint32_t headerLength, format, numTracks, division;
+    if (bytes.compare(0, 4, "MThd") != 0) return false;
+    r.pos = 4;
+    if (!r.be(4, headerLength) || headerLength < 6 || !r.be(2, format) ||
+        !r.be(2, numTracks) || !r.be(2, division)) {
+        return false;
+    }
+    if ((division & 0x8000) || division == 0) return false;  // SMPTE timebase not supported
+    r.pos = 8 + headerLength;
+
+    std::vector<GrooveNote> notes;
+    for (uint32_t track = 0; track < numTracks;) {
+        uint32_t chunkLength;
+        if (!r.has(8)) return false;
+        const bool isTrack = bytes.compare(r.pos, 4, "MTrk") == 0;
+        r.pos += 4;
+        if (!r.be(4, chunkLength) || !r.has(chunkLength)) return false;
+        const size_t chunkEnd = r.pos + chunkLength;
+        if (!isTrack) {            // skip unknown chunks
+            r.pos = chunkEnd;
+            continue;
+        }
+        ++track;
+
+        uint64_t ticks = 0;
+        uint32_t runningStatus = 0;
+        while (r.pos < chunkEnd) {
+            uint32_t delta, status, length;
+            if (!r.varLen(delta)) return false;
+            ticks += delta;
+            if (!r.has(1)) return false;
+
+            if (r.peek() & 0x80) r.u8(status);
+            else status = runningStatus;   // running status: reuse, data byte follows
+
+            if (status == 0xFF) {          // meta: type, length, data
+                uint32_t type;
+                if (!r.u8(type) || !r.varLen(length) || !r.has(length)) return false;
+                r.pos += length;
+                if (type == 0x2F) break;   // end of track
+            } else if (status == 0xF0 || status == 0xF7) {
+                if (!r.varLen(length) || !r.has(length)) return false;
+                r.pos += length;
+            } else if (status >= 0x80) {
+                runningStatus = status;
+                const int dataBytes = ((status & 0xF0) == 0xC0 || (status & 0xF0) == 0xD0) ? 1 : 2;
+                uint32_t data1 = 0, data2 = 0;
+                if (!r.u8(data1) || (dataBytes == 2 && !r.u8(data2))) return false;
+                if ((status & 0xF0) == 0x90 && data2 > 0) {
+                    notes.push_back({static_cast<double>(ticks) / division, static_cast<int>(data2)});
+                }
+            } else {
+                return false;              // data byte with no running status
+            }
+        }
+        r.pos = chunkEnd;
+    }
+
+    std::sort(notes.begin(), notes.end(),
+              [](const GrooveNote& a, const GrooveNote& b) { return a.ppq < b.ppq; });
+    outNotes = std::move(notes);
+    return true;
+}
+
+bool GrooveTemplate::loadFromMidiFile(const std::string& filepath, int length) {
+    std::string bytes;
+    std::vector<GrooveNote> notes;
+    GrooveTemplate groove;
+    if (!readFile(filepath, bytes) || !parseMidiFile(bytes, notes) || !extract(notes, length, groove)) {
+        return false;
+    }
+    *this = groove;
+    return true;
+}
+
+std::string GrooveTemplate::toBinary() const {
+    std::string bytes(BINARY_MAGIC, 4);
+    bytes.push_back(static_cast<char>(length_));
+    for (int s = 0; s < length_; ++s) {
+        bytes.push_back(static_cast<char>(static_cast<int8_t>(std::lround(timing_[s] * 254.0f))));
+        bytes.push_back(static_cast<char>(static_cast<uint8_t>(std::lround(velocity_[s] * 100.0f))));
+    }
+    return bytes;
+}
+
+bool GrooveTemplate::fromBinary(const std::string& bytes, GrooveTemplate& outGroove) {
+    if (bytes.size() < 5 || bytes.compare(0, 4, BINARY_MAGIC) != 0) return false;
+    const int length = static_cast<uint8_t>(bytes[4]);
+    if (length < 1 || length > MAX_STEPS || bytes.size() != 5 + 2 * static_cast<size_t>(length)) return false;
+
+    GrooveTemplate groove(length);
+    for (int s = 0; s < length; ++s) {
+        const int8_t timing = static_cast<int8_t>(bytes[5 + 2 * s]);
+        const uint8_t velocity = static_cast<uint8_t>(bytes[6 + 2 * s]);
+        groove.setStep(s, timing / 254.0f, velocity / 100.0f);
+    }
+    outGroove = groove;
+    return true;
+}
+
+bool GrooveTemplate::load(const std::string& filepath) {
+    std::string bytes;
+    GrooveTemplate groove;
+    if (!readFile(filepath, bytes) || !fromBinary(bytes, groove)) return false;
+    *this = groove;
+    return true;
+}
+
+bool GrooveTemplate::save(const std::string& filepath) const {
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file.is_open()) return false;
+    const std::string bytes = toBinary();
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+} // namespace scalechord
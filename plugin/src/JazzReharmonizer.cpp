@@ -3,93 +3,158 @@
 
 JazzReharmonizer::JazzReharmonizer() = default;
 
-std::vector<Substitution> JazzReharmonizer::getSubstitutions(
-    int scaleDegree, bool majorKey) const
+namespace {
+
+constexpr int NUM_DEGREES = 7;
+
+struct CatalogueEntry {
+    bool majorKey;
+    Substitution sub;
+};
+
+using K = SubstitutionKind;
+using Q = ChordQuality;
+
+// Authoring order; sorted into lookup order at compile time below
+constexpr CatalogueEntry CATALOGUE_SOURCE[] = {
+    // ---- Major key ----
+    // I - tonic
+    {true, {0, Q::Major, Q::Major7, "Maj7", 95.0f}},
+    {true, {0, Q::Major, Q::Maj9, "Maj9", 85.0f}},
+    {true, {0, Q::Major, Q::Dominant7, "I7 (V7/IV)", 70.0f, 0, K::SecondaryDominant}},
+    {true, {0, Q::Major, Q::Minor7, "im7 (modal)", 60.0f, 0, K::ModalInterchange}},
+    // ii - supertonic
+    {true, {1, Q::Minor7, Q::Minor7, "m7", 90.0f}},
+    {true, {1, Q::Minor, Q::Min9, "m9", 80.0f}},
+    {true, {1, Q::Minor7, Q::Dominant7, "II7 (V7/V)", 78.0f, 0, K::SecondaryDominant}},
+    {true, {1, Q::Minor7, Q::HalfDim7, "iim7b5 (modal)", 72.0f, 0, K::ModalInterchange}},
+    {true, {1, Q::Minor7, Q::Minor7, "ivm7 (backdoor)", 68.0f, 3, K::Backdoor}},
+    // iii - mediant
+    {true, {2, Q::Minor7, Q::Minor7, "m7", 85.0f}},
+    {true, {2, Q::Minor, Q::HalfDim7, "m7b5", 70.0f}},
+    {true, {2, Q::Minor7, Q::Dominant7, "III7 (V7/vi)", 75.0f, 0, K::SecondaryDominant}},
+    {true, {2, Q::Minor7, Q::Major7, "bIIIMaj7 (modal)", 62.0f, 11, K::ModalInterchange}},
+    // IV - subdominant
+    {true, {3, Q::Major, Q::Major7, "Maj7", 92.0f}},
+    {true, {3, Q::Major, Q::Maj9, "Maj9", 82.0f}},
+    {true, {3, Q::Major, Q::Sus4, "Sus4", 65.0f}},
+    {true, {3, Q::Major, Q::Minor7, "ivm7 (modal)", 80.0f, 0, K::ModalInterchange}},
+    // V - dominant
+    {true, {4, Q::Dominant7, Q::Dominant7, "7", 95.0f}},
+    {true, {4, Q::Dominant7, Q::Dom9, "9", 88.0f}},
+    {true, {4, Q::Dominant7, Q::Dom11, "11", 75.0f}},
+    {true, {4, Q::Dominant7, Q::Dominant7, "bII7 (tritone)", 85.0f, 6, K::Tritone}},
+    {true, {4, Q::Dominant7, Q::Dominant7, "bVII7 (backdoor)", 78.0f, 3, K::Backdoor}},
+    {true, {4, Q::Dominant7, Q::Dominant7, "US II (13#11)", 74.0f, 2, K::UpperStructure}},
+    {true, {4, Q::Dominant7, Q::Dominant7, "US bVI (7#9b13)", 70.0f, 8, K::UpperStructure}},
+    {true, {4, Q::Dominant7, Q::Dominant7, "US VI (13b9)", 66.0f, 9, K::UpperStructure}},
+    // vi - relative minor
+    {true, {5, Q::Minor7, Q::Minor7, "m7", 90.0f}},
+    {true, {5, Q::Minor, Q::Min9, "m9", 80.0f}},
+    {true, {5, Q::Minor7, Q::Dominant7, "VI7 (V7/ii)", 80.0f, 0, K::SecondaryDominant}},
+    {true, {5, Q::Minor7, Q::Major7, "bVIMaj7 (modal)", 70.0f, 11, K::ModalInterchange}},
+    // vii° - leading tone
+    {true, {6, Q::HalfDim7, Q::HalfDim7, "m7b5", 80.0f}},
+    {true, {6, Q::Diminished, Q::Diminished, "°", 75.0f}},
+    {true, {6, Q::HalfDim7, Q::Dominant7, "bVII7 (modal)", 72.0f, 11, K::ModalInterchange}},
+    {true, {6, Q::HalfDim7, Q::Dominant7, "VII7 (V7/iii)", 65.0f, 0, K::SecondaryDominant}},
+
+    // ---- Natural minor key ----
+    // i - tonic minor
+    {false, {0, Q::Minor, Q::Minor7, "m7", 90.0f}},
+    {false, {0, Q::Minor, Q::Min9, "m9", 80.0f}},
+    {false, {0, Q::Minor, Q::Dominant7, "i7 (V7/iv)", 68.0f, 0, K::SecondaryDominant}},
+    {false, {0, Q::Minor, Q::Major7, "IMaj7 (Picardy)", 65.0f, 0, K::ModalInterchange}},
+    // ii° - supertonic diminished
+    {false, {1, Q::HalfDim7, Q::HalfDim7, "m7b5", 85.0f}},
+    {false, {1, Q::HalfDim7, Q::Dominant7, "II7 (V7/V)", 70.0f, 0, K::SecondaryDominant}},
+    // III - mediant major (relative major)
+    {false, {2, Q::Major, Q::Major7, "Maj7", 88.0f}},
+    {false, {2, Q::Major, Q::Maj9, "Maj9", 78.0f}},
+    {false, {2, Q::Major, Q::Dominant7, "III7 (V7/VI)", 70.0f, 0, K::SecondaryDominant}},
+    // iv - subdominant minor
+    {false, {3, Q::Minor7, Q::Minor7, "m7", 90.0f}},
+    {false, {3, Q::Minor, Q::Min9, "m9", 80.0f}},
+    {false, {3, Q::Minor7, Q::Dominant7, "IV7 (dorian)", 74.0f, 0, K::ModalInterchange}},
+    // v - dominant minor (often V7 in jazz)
+    {false, {4, Q::Minor7, Q::Dominant7, "7", 92.0f}},
+    {false, {4, Q::Minor, Q::Dom9, "9", 82.0f}},
+    {false, {4, Q::Minor7, Q::Dominant7, "bII7 (tritone)", 84.0f, 6, K::Tritone}},
+    {false, {4, Q::Minor7, Q::Dominant7, "US bVI (7#9b13)", 72.0f, 8, K::UpperStructure}},
+    {false, {4, Q::Minor7, Q::Dominant7, "US II (13#11)", 62.0f, 2, K::UpperStructure}},
+    // VI - submediant major
+    {false, {5, Q::Major, Q::Major7, "Maj7", 88.0f}},
+    {false, {5, Q::Major, Q::Maj9, "Maj9", 78.0f}},
+    // VII - subtonic major
+    {false, {6, Q::Major, Q::Dominant7, "7", 85.0f}},
+};
+
+constexpr size_t CATALOGUE_SIZE = sizeof(CATALOGUE_SOURCE) / sizeof(CATALOGUE_SOURCE[0]);
+
+constexpr int blockOf(const CatalogueEntry& e)
 {
-    std::vector<Substitution> subs;
-    scaleDegree = scaleDegree % 7;
-
-    if (majorKey) {
-        // Major key substitutions
-        switch (scaleDegree) {
-            case 0:  // I - tonic
-                subs.push_back({0, ChordQuality::Major, ChordQuality::Major7, "Maj7", 95.0f});
-                subs.push_back({0, ChordQuality::Major, ChordQuality::Maj9, "Maj9", 85.0f});
-                break;
-
-            case 1:  // ii - supertonic
-                subs.push_back({1, ChordQuality::Minor7, ChordQuality::Minor7, "m7", 90.0f});
-                subs.push_back({1, ChordQuality::Minor, ChordQuality::Min9, "m9", 80.0f});
-                break;
-
-            case 2:  // iii - mediant
-                subs.push_back({2, ChordQuality::Minor7, ChordQuality::Minor7, "m7", 85.0f});
-                subs.push_back({2, ChordQuality::Minor, ChordQuality::HalfDim7, "m7b5", 70.0f});
-                break;
-
-            case 3:  // IV - subdominant
-                subs.push_back({3, ChordQuality::Major, ChordQuality::Major7, "Maj7", 92.0f});
-                subs.push_back({3, ChordQuality::Major, ChordQuality::Maj9, "Maj9", 82.0f});
-                subs.push_back({3, ChordQuality::Major, ChordQuality::Sus4, "Sus4", 65.0f});
-                break;
-
-            case 4:  // V - dominant
-                subs.push_back({4, ChordQuality::Dominant7, ChordQuality::Dominant7, "7", 95.0f});
-                subs.push_back({4, ChordQuality::Dominant7, ChordQuality::Dom9, "9", 88.0f});
-                subs.push_back({4, ChordQuality::Dominant7, ChordQuality::Dom11, "11", 75.0f});
-                // Tritone substitution (bII7)
-                subs.push_back({4, ChordQuality::Dominant7, ChordQuality::Dominant7, "bII7 (tritone)", 85.0f});
-                break;
-
-            case 5:  // vi - relative minor
-                subs.push_back({5, ChordQuality::Minor7, ChordQuality::Minor7, "m7", 90.0f});
-                subs.push_back({5, ChordQuality::Minor, ChordQuality::Min9, "m9", 80.0f});
-                break;
-
-            case 6:  // vii° - leading tone
-                subs.push_back({6, ChordQuality::HalfDim7, ChordQuality::HalfDim7, "m7b5", 80.0f});
-                subs.push_back({6, ChordQuality::Diminished, ChordQuality::Diminished, "°", 75.0f});
-                break;
+    return (e.majorKey ? 0 : NUM_DEGREES) + e.sub.degree;
+}
+
+// Grouped by (key, degree), highest musicality first; stable within ties
+struct Catalogue {
+    std::array<Substitution, CATALOGUE_SIZE> entries{};
+    std::array<size_t, NUM_DEGREES * 2 + 1> blockStart{};
+};
+
+constexpr Catalogue buildCatalogue()
+{
+    std::array<CatalogueEntry, CATALOGUE_SIZE> sorted{};
+    for (size_t i = 0; i < CATALOGUE_SIZE; ++i) sorted[i] = CATALOGUE_SOURCE[i];
+
+    for (size_t i = 1; i < CATALOGUE_SIZE; ++i) {  // insertion sort
+        CatalogueEntry e = sorted[i];
+        size_t j = i;
+        while (j > 0 && (blockOf(sorted[j - 1]) > blockOf(e) ||
+                         (blockOf(sorted[j - 1]) == blockOf(e) && sorted[j - 1].sub.musicality < e.sub.musicality))) {
+            sorted[j] = sorted[j - 1];
+            --j;
         }
-    } else {
-        // Natural minor key substitutions
-        switch (scaleDegree) {
-            case 0:  // i - tonic minor
-                subs.push_back({0, ChordQuality::Minor, ChordQuality::Minor7, "m7", 90.0f});
-                subs.push_back({0, ChordQuality::Minor, ChordQuality::Min9, "m9", 80.0f});
-                break;
-
-            case 1:  // ii° - supertonic diminished
-                subs.push_back({1, ChordQuality::HalfDim7, ChordQuality::HalfDim7, "m7b5", 85.0f});
-                break;
-
-            case 2:  // III - mediant major (relative major)
-                subs.push_back({2, ChordQuality::Major, ChordQuality::Major7, "Maj7", 88.0f});
-                subs.push_back({2, ChordQuality::Major, ChordQuality::Maj9, "Maj9", 78.0f});
-                break;
-
-            case 3:  // iv - subdominant minor
-                subs.push_back({3, ChordQuality::Minor7, ChordQuality::Minor7, "m7", 90.0f});
-                subs.push_back({3, ChordQuality::Minor, ChordQuality::Min9, "m9", 80.0f});
-                break;
-
-            case 4:  // v - dominant minor (often V7 in jazz)
-                subs.push_back({4, ChordQuality::Minor7, ChordQuality::Dominant7, "7", 92.0f});
-                subs.push_back({4, ChordQuality::Minor, ChordQuality::Dom9, "9", 82.0f});
-                break;
-
-            case 5:  // VI - submediant major
-                subs.push_back({5, ChordQuality::Major, ChordQuality::Major7, "Maj7", 88.0f});
-                subs.push_back({5, ChordQuality::Major, ChordQuality::Maj9, "Maj9", 78.0f});
-                break;
-
-            case 6:  // VII - subtonic major
-                subs.push_back({6, ChordQuality::Major, ChordQuality::Dominant7, "7", 85.0f});
-                break;
+        sorted[j] = e;
+    }
+
+    Catalogue c{};
+    for (size_t i = 0; i < CATALOGUE_SIZE; ++i) {
+        c.entries[i] = sorted[i].sub;
+        ++c.blockStart[blockOf(sorted[i]) + 1];
+    }
+    for (int b = 1; b <= NUM_DEGREES * 2; ++b) c.blockStart[b] += c.blockStart[b - 1];
+    return c;
+}
+
+constexpr Catalogue CATALOGUE = buildCatalogue();
+
+constexpr bool isSorted(const Catalogue& c)
+{
+    for (int b = 0; b < NUM_DEGREES * 2; ++b) {
+        for (size_t i = c.blockStart[b]; i < c.blockStart[b + 1]; ++i) {
+            if (c.entries[i].degree != b % NUM_DEGREES) return false;
+            if (i > c.blockStart[b] && c.entries[i - 1].musicality < c.entries[i].musicality) return false;
         }
     }
+    return c.blockStart[NUM_DEGREES * 2] == CATALOGUE_SIZE;
+}
+static_assert(isSorted(CATALOGUE), "substitution catalogue must be grouped by degree and sorted by musicality");
+
+} // namespace
 
-    return subs;
+SubstitutionSpan JazzReharmonizer::getSubstitutions(
+    int scaleDegree, bool majorKey) const noexcept
+{
+    scaleDegree = ((scaleDegree % NUM_DEGREES) + NUM_DEGREES) % NUM_DEGREES;
+    const int block = (majorKey ? 0 : NUM_DEGREES) + scaleDegree;
+    const size_t begin = CATALOGUE.blockStart[block];
+    return {CATALOGUE.entries.data() + begin, CATALOGUE.blockStart[block + 1] - begin};
+}
+
+SubstitutionSpan JazzReharmonizer::getCatalogue() noexcept
+{
+    return {CATALOGUE.entries.data(), CATALOGUE_SIZE};
 }
 
 int JazzReharmonizer::getTritone(int pitch)
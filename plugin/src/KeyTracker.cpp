@@ -0,0 +1,162 @@
+#include "KeyTracker.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace scalechord {
+
+namespace {
+
+constexpr int PADDED_KEYS = KeyTracker::PADDED_KEYS;
+
+// Template weights: every in-scale pitch class counts, the tonic and its fifth
+// a little more (separates modes sharing a pitch set), out-of-scale notes count against
+constexpr float IN_SCALE = 1.0f;
+constexpr float TONIC_BONUS = 1.0f;
+constexpr float FIFTH_BONUS = 0.5f;
+constexpr float OUT_OF_SCALE = -1.0f;
+
+using TemplateRow = std::array<float, PADDED_KEYS>;
+
+// templates()[pc][key]: contribution of pitch class pc to each key's score. Stored
+// pitch-class-major so a note-on is one contiguous multiply-add over all keys.
+const std::array<TemplateRow, 12>& templates() {
+    alignas(32) static const std::array<TemplateRow, 12> table = [] {
+        std::array<TemplateRow, 12> rows{};
+        for (int root = 0; root < 12; ++root) {
+            for (int s = 0; s < NUM_SCALE_TYPES; ++s) {
+                int key = root * NUM_SCALE_TYPES + s;
+                const ScaleTable& scale = scaleTable(static_cast<ScaleType>(s), root);
+                for (int pc = 0; pc < 12; ++pc) {
+                    float w = scale.pitchClasses.contains(pc) ? IN_SCALE : OUT_OF_SCALE;
+                    if (pc == root) w += TONIC_BONUS;
+                    if (pc == (root + 7) % 12 && scale.pitchClasses.contains(pc)) w += FIFTH_BONUS;
+                    rows[pc][key] = w;
+                }
+            }
+        }
+        return rows;  // padding keys stay 0
+    }();
+    return table;
+}
+
+// scores[k] += weight * row[k] for all keys
+inline void addScaled(float* scores, const float* row, float weight) noexcept {
+#if defined(__AVX__)
+    const __m256 w = _mm256_set1_ps(weight);
+    for (int k = 0; k < PADDED_KEYS; k += 8) {
+        __m256 s = _mm256_load_ps(scores + k);
+        s = _mm256_add_ps(s, _mm256_mul_ps(w, _mm256_load_ps(row + k)));
+        _mm256_store_ps(scores + k, s);
+    }
+#elif defined(__SSE2__)
+    const __m128 w = _mm_set1_ps(weight);
+    for (int k = 0; k < PADDED_KEYS; k += 4) {
+        __m128 s = _mm_load_ps(scores + k);
+        s = _mm_add_ps(s, _mm_mul_ps(w, _mm_load_ps(row + k)));
+        _mm_store_ps(scores + k, s);
+    }
+#else
+    for (int k = 0; k < PADDED_KEYS; ++k) scores[k] += weight * row[k];
+#endif
+}
+
+} // namespace
+
+KeyTracker::KeyTracker() {
+    setSettings(settings_);
+}
+
+KeyTracker::KeyTracker(const KeyTrackerSettings& s) {
+    setSettings(s);
+}
+
+void KeyTracker::setSettings(const KeyTrackerSettings& s) {
+    settings_ = s;
+    settings_.halfLifeNotes = std::max(1.0f, settings_.halfLifeNotes);
+    settings_.hysteresis = std::max(0.0f, settings_.hysteresis);
+    settings_.holdNotes = std::max(1, settings_.holdNotes);
+    growth_ = std::pow(2.0f, 1.0f / settings_.halfLifeNotes);
+}
+
+bool KeyTracker::noteOn(int midiNote, int velocity) noexcept {
+    if (midiNote < 0 || midiNote > 127 || velocity <= 0) return false;
+
+    float amount = settings_.velocityWeighted ? std::min(velocity, 127) / 127.0f : 1.0f;
+    float w = weight_ * amount;
+    int pc = midiNote % 12;
+
+    histogram_[pc] += w;
+    mass_ += w;
+    addScaled(scores_.data(), templates()[pc].data(), w);
+
+    weight_ *= growth_;
+    if (weight_ > 1.0e6f) rescale();
+
+    // Hysteresis: a challenger must keep a clear lead for holdNotes note-ons
+    int best = bestKey();
+    if (best == current_ || scores_[best] - scores_[current_] <= settings_.hysteresis * mass_) {
+        challenger_ = -1;
+        challengerNotes_ = 0;
+        return false;
+    }
+    if (best != challenger_) {
+        challenger_ = best;
+        challengerNotes_ = 0;
+    }
+    if (++challengerNotes_ < settings_.holdNotes) return false;
+
+    current_ = best;
+    challenger_ = -1;
+    challengerNotes_ = 0;
+    return true;
+}
+
+std::array<float, 12> KeyTracker::getHistogram() const noexcept {
+    std::array<float, 12> normalized{};
+    if (mass_ <= 0.0f) return normalized;
+    for (int pc = 0; pc < 12; ++pc) normalized[pc] = histogram_[pc] / mass_;
+    return normalized;
+}
+
+void KeyTracker::reset() noexcept {
+    histogram_.fill(0.0f);
+    scores_.fill(0.0f);
+    weight_ = 1.0f;
+    mass_ = 0.0f;
+    current_ = 0;
+    challenger_ = -1;
+    challengerNotes_ = 0;
+}
+
+int KeyTracker::bestKey() const noexcept {
+    // First maximum wins: lower root, then scale order (same as ScaleMapper::detectScale)
+    int best = 0;
+    for (int k = 1; k < NUM_KEYS; ++k) {
+        if (scores_[k] > scores_[best]) best = k;
+    }
+    return best;
+}
+
+KeyEstimate KeyTracker::estimateFor(int key) const noexcept {
+    KeyEstimate e;
+    e.rootNote = key / NUM_SCALE_TYPES;
+    e.scale = static_cast<ScaleType>(key % NUM_SCALE_TYPES);
+    e.fit = mass_ > 0.0f ? scores_[key] / mass_ : 0.0f;
+    return e;
+}
+
+void KeyTracker::rescale() noexcept {
+    float inv = 1.0f / weight_;
+    for (float& h : histogram_) h *= inv;
+    for (float& s : scores_) s *= inv;
+    mass_ *= inv;
+    weight_ = 1.0f;
+}
+
+} // namespace scalechord
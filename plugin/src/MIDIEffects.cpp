@@ -1,115 +1,184 @@
 // MIDI Effects implementation
 #include "MIDIEffects.h"
-#include <random>
-#include <ctime>
 #include <cmath>
 #include <algorithm>
 
 namespace scalechord {
 
-static std::mt19937 g_rng_effects(static_cast<unsigned>(std::time(nullptr)));
-static std::uniform_real_distribution<float> g_dist_effects(0.0f, 1.0f);
-
 // ============ ARPEGGIATOR ============
 
-Arpeggiator::Arpeggiator(const ArpeggiatorSettings& s) : settings_(s) {}
+Arpeggiator::Arpeggiator(const ArpeggiatorSettings& s) : settings_(s) {
+    compilePattern();
+}
 
 void Arpeggiator::setSettings(const ArpeggiatorSettings& s) {
     settings_ = s;
+    compilePattern();
 }
 
 void Arpeggiator::setChordNotes(const std::vector<int>& notes) {
-    chordNotes_ = notes;
-    std::sort(chordNotes_.begin(), chordNotes_.end());
+    numChordNotes_ = std::min(static_cast<int>(notes.size()), MAX_CHORD_NOTES);
+    std::copy(notes.begin(), notes.begin() + numChordNotes_, chordNotes_.begin());
+    std::sort(chordNotes_.begin(), chordNotes_.begin() + numChordNotes_);
     if (settings_.restartOnNewNote) {
         reset();
+        pendingRestart_ = true;
     }
+    compilePattern();
 }
 
 void Arpeggiator::reset() {
     currentStep_ = 0;
+    cursor_ = 0;
     phaseFractional_ = 0.0f;
     notePhase_ = 0.0f;
 }
 
-float Arpeggiator::getStepDuration(float sampleRate, float tempoHz) {
+double Arpeggiator::getStepLengthQn(double bpm) const {
+    switch (settings_.sync) {
+        case ArpeggiatorSync::Tempo16th:    return 0.25;
+        case ArpeggiatorSync::Tempo8th:     return 0.5;
+        case ArpeggiatorSync::TempoQuarter: return 1.0;
+        case ArpeggiatorSync::TempoHalf:    return 2.0;
+        case ArpeggiatorSync::Freerun:
+        default:
+            // Fixed rate in Hz, expressed in beats at the current tempo
+            return bpm / (60.0 * std::max(0.01f, settings_.tempoHz));
+    }
+}
+
+float Arpeggiator::getStepDuration(float sampleRate, float bpm) {
     if (settings_.sync == ArpeggiatorSync::Freerun) {
         return sampleRate / settings_.tempoHz;
     }
-    
-    // Convert sync to multiplier
-    float multiplier = 1.0f;
-    switch (settings_.sync) {
-        case ArpeggiatorSync::Tempo16th: multiplier = 1.0f; break;
-        case ArpeggiatorSync::Tempo8th:  multiplier = 2.0f; break;
-        case ArpeggiatorSync::TempoQuarter: multiplier = 4.0f; break;
-        case ArpeggiatorSync::TempoHalf: multiplier = 8.0f; break;
-        default: break;
-    }
-    
-    return (sampleRate * 60.0f / tempoHz) * multiplier;
+    return static_cast<float>(sampleRate * 60.0 / bpm * getStepLengthQn(bpm));
 }
 
-int Arpeggiator::getNextNote() {
-    if (chordNotes_.empty()) return -1;
-    
-    std::vector<int> sequence;
-    
+void Arpeggiator::compilePattern() {
+    const int octaves = std::clamp(settings_.octaveRange, 1, MAX_OCTAVES);
+    const int* notes = chordNotes_.data();
+    const int count = numChordNotes_;
+    int length = 0;
+
     // Build arpeggio sequence based on mode
     if (settings_.mode == ArpeggiatorMode::Up) {
-        for (int oct = 0; oct < settings_.octaveRange; ++oct) {
-            for (int note : chordNotes_) {
-                sequence.push_back(note + oct * 12);
-            }
+        for (int oct = 0; oct < octaves; ++oct) {
+            for (int i = 0; i < count; ++i) pattern_[length++] = notes[i] + oct * 12;
         }
     } else if (settings_.mode == ArpeggiatorMode::Down) {
-        for (int oct = settings_.octaveRange - 1; oct >= 0; --oct) {
-            for (auto it = chordNotes_.rbegin(); it != chordNotes_.rend(); ++it) {
-                sequence.push_back(*it + oct * 12);
-            }
+        for (int oct = octaves - 1; oct >= 0; --oct) {
+            for (int i = count - 1; i >= 0; --i) pattern_[length++] = notes[i] + oct * 12;
         }
     } else if (settings_.mode == ArpeggiatorMode::UpDown) {
-        for (int oct = 0; oct < settings_.octaveRange; ++oct) {
-            for (int note : chordNotes_) {
-                sequence.push_back(note + oct * 12);
-            }
+        for (int oct = 0; oct < octaves; ++oct) {
+            for (int i = 0; i < count; ++i) pattern_[length++] = notes[i] + oct * 12;
         }
-        for (int oct = settings_.octaveRange - 2; oct >= 0; --oct) {
-            for (auto it = chordNotes_.rbegin(); it != chordNotes_.rend(); ++it) {
-                sequence.push_back(*it + oct * 12);
-            }
+        for (int oct = octaves - 2; oct >= 0; --oct) {
+            for (int i = count - 1; i >= 0; --i) pattern_[length++] = notes[i] + oct * 12;
+        }
+    } else {
+        // Random (shuffled below and again at each wrap), Strum, Hold
+        for (int i = 0; i < count; ++i) pattern_[length++] = notes[i];
+        if (settings_.mode == ArpeggiatorMode::Random) {
+            std::shuffle(pattern_.begin(), pattern_.begin() + length, rng_);
         }
-    } else if (settings_.mode == ArpeggiatorMode::Random) {
-        sequence = chordNotes_;
-        std::shuffle(sequence.begin(), sequence.end(), g_rng_effects);
-    } else if (settings_.mode == ArpeggiatorMode::Strum) {
-        // Quick strum over all notes
-        sequence = chordNotes_;
-    } else { // Hold
-        sequence = chordNotes_;
     }
-    
-    if (sequence.empty()) return -1;
-    return sequence[currentStep_ % sequence.size()];
+
+    patternLength_ = length;
+    cursor_ = length > 0 ? currentStep_ % length : 0;
 }
 
-int Arpeggiator::process(float sampleRate, float tempoHz) {
-    if (chordNotes_.empty() || settings_.mode == ArpeggiatorMode::Hold) {
+int Arpeggiator::getNextNote() {
+    if (patternLength_ == 0) return -1;
+    return pattern_[cursor_];
+}
+
+int Arpeggiator::process(float sampleRate, float bpm) {
+    if (patternLength_ == 0 || settings_.mode == ArpeggiatorMode::Hold) {
         return -1;
     }
     
-    float stepDuration = getStepDuration(sampleRate, tempoHz);
+    float stepDuration = getStepDuration(sampleRate, bpm);
     notePhase_ += 1.0f / stepDuration;
     
     if (notePhase_ >= 1.0f) {
         notePhase_ -= 1.0f;
         currentStep_++;
+        if (++cursor_ >= patternLength_) {
+            cursor_ = 0;
+            if (settings_.mode == ArpeggiatorMode::Random) {
+                std::shuffle(pattern_.begin(), pattern_.begin() + patternLength_, rng_);
+            }
+        }
         return getNextNote();
     }
     
     return -1;
 }
 
+void Arpeggiator::processBlock(const PlayheadInfo& playhead, int numSamples, EventSink& sink) {
+    if (numSamples <= 0 || playhead.sampleRate <= 0.0 || playhead.bpm <= 0.0) return;
+
+    const double samplesPerQn = 60.0 * playhead.sampleRate / playhead.bpm;
+    const double blockStart = playhead.ppqPosition;
+    const double blockEnd = blockStart + numSamples / samplesPerQn;
+    auto offsetOf = [&](double ppq) {
+        int offset = static_cast<int>(std::lround((ppq - blockStart) * samplesPerQn));
+        return std::max(0, std::min(numSamples - 1, offset));
+    };
+
+    // Our estimate of where this block starts assumed the last block's tempo, so
+    // under a tempo ramp the host's position drifts from it a little. Only a
+    // move of more than a block is a loop/relocate; smaller drift continues
+    // from where the last block ended, so no step is replayed or skipped.
+    const double blockQn = numSamples / samplesPerQn;
+    const bool jumped = expectedPpq_ >= 0.0 && std::abs(blockStart - expectedPpq_) > blockQn;
+    const double from = (expectedPpq_ >= 0.0 && !jumped) ? expectedPpq_ : blockStart;
+
+    // Transport stopped, loop/relocate, or nothing to play: end the current note now
+    if (soundingNote_ >= 0 && (!playhead.isPlaying || jumped || patternLength_ == 0 ||
+                               settings_.mode == ArpeggiatorMode::Hold)) {
+        sink.noteOff(soundingNote_, 0);
+        soundingNote_ = -1;
+    }
+    expectedPpq_ = playhead.isPlaying ? blockEnd : -1.0;   // a restart may be anywhere
+    if (!playhead.isPlaying || patternLength_ == 0 || settings_.mode == ArpeggiatorMode::Hold) return;
+
+    const double stepQn = getStepLengthQn(playhead.bpm);
+    const double swingQn = std::clamp(settings_.swing, 0.0f, 1.0f) * stepQn / 3.0;
+    const double gateQn = std::clamp(settings_.gate, 0.05f, 1.0f) * stepQn;
+
+    // First step that can start in the block (a swung odd step may start after its grid line)
+    for (int64_t k = static_cast<int64_t>(std::floor((std::min(from, blockStart) - swingQn) / stepQn)); ; ++k) {
+        const double stepStart = k * stepQn + ((k & 1) ? swingQn : 0.0);
+
+        // A note-off due before this step (or before the block ends) goes first
+        if (soundingNote_ >= 0 && noteOffPpq_ < blockEnd && noteOffPpq_ <= stepStart) {
+            sink.noteOff(soundingNote_, offsetOf(noteOffPpq_));
+            soundingNote_ = -1;
+        }
+        if (stepStart >= blockEnd) break;
+        if (stepStart < from) continue;
+
+        if (pendingRestart_) {
+            anchorStep_ = k;
+            pendingRestart_ = false;
+        }
+        int64_t index = (k - anchorStep_) % patternLength_;
+        if (index < 0) index += patternLength_;
+        if (index == 0 && settings_.mode == ArpeggiatorMode::Random && k != anchorStep_) {
+            std::shuffle(pattern_.begin(), pattern_.begin() + patternLength_, rng_);
+        }
+
+        if (soundingNote_ >= 0) sink.noteOff(soundingNote_, offsetOf(stepStart));
+        const int note = pattern_[static_cast<size_t>(index)];
+        sink.noteOn(note, velocity_, offsetOf(stepStart));
+        soundingNote_ = note;
+        noteOffPpq_ = stepStart + gateQn;
+        currentStep_ = static_cast<int>(k - anchorStep_);
+    }
+}
+
 // ============ HUMANIZER ============
 
 Humanizer::Humanizer(const HumanizerSettings& s) : settings_(s) {}
@@ -124,7 +193,7 @@ int Humanizer::humanizeVelocity(int velocity) {
     }
     
     float variation = velocity * settings_.velocityVariation;
-    float randomOffset = g_dist_effects(g_rng_effects) * 2.0f - 1.0f;
+    float randomOffset = rng_.nextBipolar();
     int humanized = static_cast<int>(velocity + randomOffset * variation);
     
     return std::clamp(humanized, 0, 127);
@@ -135,16 +204,26 @@ float Humanizer::humanizeNoteDelay(float sampleRate) {
         return 0.0f;
     }
     
-    float randomOffset = g_dist_effects(g_rng_effects) * 2.0f - 1.0f;
+    float randomOffset = rng_.nextBipolar();
     return randomOffset * settings_.timingVariation * sampleRate * 0.01f;
 }
 
+double Humanizer::grooveTimingQn(double ppq) const noexcept {
+    if (!settings_.enabled || !hasGroove_) return 0.0;
+    return groove_.timingOffsetQn(ppq) * settings_.grooveAmount;
+}
+
+int Humanizer::grooveVelocity(int velocity, double ppq) const noexcept {
+    if (!settings_.enabled || !hasGroove_) return velocity;
+    return groove_.applyVelocity(velocity, ppq, settings_.grooveAmount);
+}
+
 float Humanizer::humanizePitch() {
     if (!settings_.enabled || settings_.tuneDeviation <= 0.0f) {
         return 0.0f;
     }
     
-    float randomOffset = g_dist_effects(g_rng_effects) * 2.0f - 1.0f;
+    float randomOffset = rng_.nextBipolar();
     return randomOffset * settings_.tuneDeviation * 100.0f;  // cents
 }
 
@@ -167,7 +246,7 @@ bool NoteProbability::shouldPlayNote(int stepIndex) {
     }
     
     // Check probability
-    return g_dist_effects(g_rng_effects) <= settings_.probability;
+    return rng_.nextFloat() <= settings_.probability;
 }
 
 } // namespace scalechord
@@ -0,0 +1,360 @@
+#include "MicrotonalMapper.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace scalechord {
+
+namespace {
+
+int floorDiv(int a, int b) {
+    int q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+std::string trim(const std::string& s) {
+    const char* ws = " \t\r\n";
+    size_t start = s.find_first_not_of(ws);
+    if (start == std::string::npos) return "";
+    return s.substr(start, s.find_last_not_of(ws) - start + 1);
+}
+
+std::string firstToken(const std::string& line) {
+    std::istringstream in(line);
+    std::string token;
+    in >> token;
+    return token;
+}
+
+// Non-comment lines of a Scala file ('!' starts a comment line)
+std::vector<std::string> scalaLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[0] == '!') continue;
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+bool parseInt(const std::string& token, int& out) {
+    if (token.empty()) return false;
+    char* end = nullptr;
+    long v = std::strtol(token.c_str(), &end, 10);
+    if (*end != '\0') return false;
+    out = static_cast<int>(v);
+    return true;
+}
+
+// Scala pitch: cents if it contains a '.', otherwise a ratio "n/d" or "n"
+bool parsePitch(const std::string& token, double& outCents) {
+    if (token.empty()) return false;
+    char* end = nullptr;
+    if (token.find('.') != std::string::npos) {
+        outCents = std::strtod(token.c_str(), &end);
+        return *end == '\0';
+    }
+    long long num = std::strtoll(token.c_str(), &end, 10);
+    long long den = 1;
+    if (*end == '/') {
+        const char* denStart = end + 1;
+        den = std::strtoll(denStart, &end, 10);
+        if (end == denStart) return false;
+    }
+    if (*end != '\0' || num <= 0 || den <= 0) return false;
+    outCents = 1200.0 * std::log2(static_cast<double>(num) / static_cast<double>(den));
+    return true;
+}
+
+bool readFile(const std::string& filepath, std::string& outText) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    outText = buffer.str();
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// Tuning
+// ============================================================================
+
+Tuning Tuning::equalDivision(int divisions, double periodCents) {
+    Tuning t;
+    divisions = std::max(1, divisions);
+    t.description = std::to_string(divisions) + "-EDO";
+    for (int i = 1; i <= divisions; ++i) {
+        t.cents.push_back(periodCents * i / divisions);
+    }
+    return t;
+}
+
+double Tuning::degreeCents(int degree) const noexcept {
+    if (cents.empty()) return degree * 100.0;
+    int n = size();
+    int octave = floorDiv(degree, n);
+    int idx = degree - octave * n;
+    return octave * periodCents() + (idx == 0 ? 0.0 : cents[idx - 1]);
+}
+
+// ============================================================================
+// MicrotonalMapper
+// ============================================================================
+
+MicrotonalMapper::MicrotonalMapper()
+    : tuning_(Tuning::equalDivision(12))
+{
+    held_.fill(MicrotonalNote{});
+    rebuildTable();
+}
+
+void MicrotonalMapper::setSettings(const MicrotonalSettings& s) {
+    settings_ = s;
+    settings_.firstMemberChannel = std::max(1, std::min(16, settings_.firstMemberChannel));
+    settings_.numMemberChannels = std::max(1, std::min(17 - settings_.firstMemberChannel,
+                                                       settings_.numMemberChannels));
+    rebuildTable();
+}
+
+MicrotonalSettings MicrotonalMapper::getSettings() const noexcept {
+    return settings_;
+}
+
+void MicrotonalMapper::setTuning(const Tuning& t) {
+    if (t.cents.empty() || t.periodCents() <= 0.0) return;
+    tuning_ = t;
+    rebuildTable();
+}
+
+void MicrotonalMapper::setKeyboardMapping(const KeyboardMapping& m) {
+    mapping_ = m;
+    rebuildTable();
+}
+
+bool MicrotonalMapper::loadScala(const std::string& filepath) {
+    std::string text;
+    Tuning t;
+    if (!readFile(filepath, text) || !parseScala(text, t)) return false;
+    setTuning(t);
+    return true;
+}
+
+bool MicrotonalMapper::loadKeyboardMapping(const std::string& filepath) {
+    std::string text;
+    KeyboardMapping m;
+    if (!readFile(filepath, text) || !parseKeyboardMapping(text, m)) return false;
+    setKeyboardMapping(m);
+    return true;
+}
+
+bool MicrotonalMapper::parseScala(const std::string& text, Tuning& outTuning) {
+    std::vector<std::string> lines = scalaLines(text);
+    if (lines.size() < 2) return false;
+
+    Tuning t;
+    t.description = trim(lines[0]);
+
+    int count = 0;
+    if (!parseInt(firstToken(lines[1]), count) || count <= 0) return false;
+    if (static_cast<int>(lines.size()) < 2 + count) return false;
+
+    for (int i = 0; i < count; ++i) {
+        double cents = 0.0;
+        if (!parsePitch(firstToken(lines[2 + i]), cents)) return false;
+        t.cents.push_back(cents);
+    }
+    if (t.periodCents() <= 0.0) return false;
+
+    outTuning = std::move(t);
+    return true;
+}
+
+bool MicrotonalMapper::parseKeyboardMapping(const std::string& text, KeyboardMapping& outMapping) {
+    // Blank lines carry no fields in a .kbm
+    std::vector<std::string> tokens;
+    for (const auto& line : scalaLines(text)) {
+        std::string token = firstToken(line);
+        if (!token.empty()) tokens.push_back(token);
+    }
+    if (tokens.size() < 7) return false;
+
+    KeyboardMapping m;
+    char* end = nullptr;
+    if (!parseInt(tokens[0], m.mapSize) || !parseInt(tokens[1], m.firstNote) ||
+        !parseInt(tokens[2], m.lastNote) || !parseInt(tokens[3], m.middleNote) ||
+        !parseInt(tokens[4], m.referenceNote)) {
+        return false;
+    }
+    m.referenceFrequency = std::strtod(tokens[5].c_str(), &end);
+    if (*end != '\0' || m.referenceFrequency <= 0.0) return false;
+    if (!parseInt(tokens[6], m.octaveDegree)) return false;
+
+    if (m.mapSize < 0 || m.firstNote < 0 || m.lastNote > 127 || m.firstNote > m.lastNote ||
+        m.middleNote < 0 || m.middleNote > 127 || m.referenceNote < 0 || m.referenceNote > 127) {
+        return false;
+    }
+
+    // Missing trailing entries are unmapped
+    m.mapping.assign(m.mapSize, -1);
+    for (int i = 0; i < m.mapSize && 7 + i < static_cast<int>(tokens.size()); ++i) {
+        const std::string& token = tokens[7 + i];
+        if (token == "x" || token == "X") continue;
+        if (!parseInt(token, m.mapping[i]) || m.mapping[i] < 0) return false;
+    }
+
+    outMapping = std::move(m);
+    return true;
+}
+
+double MicrotonalMapper::keyCents(int key, bool& mapped) const noexcept {
+    mapped = true;
+    int offset = key - mapping_.middleNote;
+    if (mapping_.mapSize <= 0) return tuning_.degreeCents(offset);
+
+    int repeat = floorDiv(offset, mapping_.mapSize);
+    int idx = offset - repeat * mapping_.mapSize;
+    int degree = idx < static_cast<int>(mapping_.mapping.size()) ? mapping_.mapping[idx] : -1;
+    if (degree < 0) {
+        mapped = false;
+        return 0.0;
+    }
+
+    double octaveCents = mapping_.octaveDegree > 0 ? tuning_.degreeCents(mapping_.octaveDegree)
+                                                   : tuning_.periodCents();
+    return repeat * octaveCents + tuning_.degreeCents(degree);
+}
+
+void MicrotonalMapper::rebuildTable() {
+    auto next = std::make_unique<RetuneTable>();
+    next->settings = settings_;
+
+    // Frequency of degree 0 (on the middle note), anchored by the reference key.
+    // An unmapped reference key falls back to a 12-TET distance from the middle note.
+    bool refMapped = false;
+    double refCents = keyCents(mapping_.referenceNote, refMapped);
+    if (!refMapped) refCents = (mapping_.referenceNote - mapping_.middleNote) * 100.0;
+    double rootFreq = mapping_.referenceFrequency * std::pow(2.0, -refCents / 1200.0);
+
+    // One period of tuning pitches, sorted, for quantizing
+    std::vector<double> period;
+    for (int i = 0; i < tuning_.size(); ++i) period.push_back(tuning_.degreeCents(i));
+    std::sort(period.begin(), period.end());
+    double periodCents = tuning_.periodCents();
+
+    float bendRange = std::max(0.01f, settings_.pitchBendRange);
+
+    for (int key = 0; key < 128; ++key) {
+        RetunedNote& out = next->notes[key];
+        out = RetunedNote{};
+        next->frequencies[key] = 0.0;
+
+        double cents = 0.0;
+        if (settings_.mode == MicrotonalMode::KeyboardMap) {
+            if (key < mapping_.firstNote || key > mapping_.lastNote) continue;
+            bool mapped = false;
+            cents = keyCents(key, mapped);
+            if (!mapped) continue;
+        } else {
+            // Nearest tuning pitch to the key's 12-TET pitch (ties go down)
+            double target = 1200.0 * std::log2(440.0 * std::pow(2.0, (key - 69) / 12.0) / rootFreq);
+            int octave = static_cast<int>(std::floor(target / periodCents));
+            double bestDist = 1e9;
+            for (int o = octave - 1; o <= octave + 1; ++o) {
+                for (double p : period) {
+                    double candidate = o * periodCents + p;
+                    double dist = std::fabs(candidate - target);
+                    if (dist < bestDist - 1e-9) {
+                        bestDist = dist;
+                        cents = candidate;
+                    }
+                }
+            }
+        }
+
+        double freq = rootFreq * std::pow(2.0, cents / 1200.0);
+        double midi = 69.0 + 12.0 * std::log2(freq / 440.0);
+        long note = std::lround(midi);
+        if (note < 0 || note > 127) continue;
+
+        long bend = 8192 + std::lround((midi - note) / bendRange * 8192.0);
+        out.note = static_cast<int8_t>(note);
+        out.pitchBend = static_cast<uint16_t>(std::max(0L, std::min(16383L, bend)));
+        next->frequencies[key] = freq;
+    }
+
+    table_.publish(std::move(next));
+}
+
+RetunedNote MicrotonalMapper::retune(int incomingMidiNote) const noexcept {
+    if (incomingMidiNote < 0 || incomingMidiNote > 127) return RetunedNote{};
+    auto table = table_.read();
+    return table->notes[incomingMidiNote];
+}
+
+double MicrotonalMapper::getFrequency(int incomingMidiNote) const noexcept {
+    if (incomingMidiNote < 0 || incomingMidiNote > 127) return 0.0;
+    auto table = table_.read();
+    return table->frequencies[incomingMidiNote];
+}
+
+MicrotonalNote MicrotonalMapper::noteOn(int incomingMidiNote, MicrotonalNote* released) noexcept {
+    if (released) *released = MicrotonalNote{};
+    if (incomingMidiNote < 0 || incomingMidiNote > 127) return MicrotonalNote{};
+
+    // Retrigger of a held key: free its channel first and hand the old note
+    // back, since the new press may land on a different channel
+    if (held_[incomingMidiNote].channel > 0) {
+        MicrotonalNote previous = noteOff(incomingMidiNote);
+        if (released) *released = previous;
+    }
+
+    auto table = table_.read();
+    const RetunedNote& r = table->notes[incomingMidiNote];
+    if (r.note < 0) return MicrotonalNote{};
+
+    // Round-robin over member channels, preferring a free one; if all are busy
+    // share the least-loaded channel (its bend will be shared too)
+    int first = table->settings.firstMemberChannel;
+    int count = table->settings.numMemberChannels;
+    int channel = first;
+    int fewest = 256;
+    for (int i = 0; i < count; ++i) {
+        int ch = first + (nextChannel_ + i) % count;
+        if (notesOnChannel_[ch - 1] < fewest) {
+            fewest = notesOnChannel_[ch - 1];
+            channel = ch;
+            if (fewest == 0) break;
+        }
+    }
+    nextChannel_ = (channel - first + 1) % count;
+    ++notesOnChannel_[channel - 1];
+
+    MicrotonalNote result{r.note, r.pitchBend, channel};
+    held_[incomingMidiNote] = result;
+    return result;
+}
+
+MicrotonalNote MicrotonalMapper::noteOff(int incomingMidiNote) noexcept {
+    if (incomingMidiNote < 0 || incomingMidiNote > 127) return MicrotonalNote{};
+
+    // Release exactly what was sent, even if the tuning changed since
+    MicrotonalNote result = held_[incomingMidiNote];
+    if (result.channel > 0 && notesOnChannel_[result.channel - 1] > 0) {
+        --notesOnChannel_[result.channel - 1];
+    }
+    held_[incomingMidiNote] = MicrotonalNote{};
+    return result;
+}
+
+void MicrotonalMapper::reset() noexcept {
+    held_.fill(MicrotonalNote{});
+    notesOnChannel_.fill(0);
+    nextChannel_ = 0;
+}
+
+} // namespace scalechord
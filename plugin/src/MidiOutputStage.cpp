@@ -0,0 +1,85 @@
+#include "MidiOutputStage.h"
+#include <algorithm>
+
+namespace scalechord {
+
+MidiOutputStage::MidiOutputStage() = default;
+
+bool MidiOutputStage::noteOn(int channel, int note, int velocity, int samplePosition) noexcept {
+    if (!valid(channel, note)) return false;
+    uint8_t& count = holders_[key(channel, note)];
+    if (count == 255) return false;
+    if (count++ > 0) return false;  // already sounding for another holder
+
+    queue(MidiNoteEvent::Type::NoteOn, channel, note, std::max(1, std::min(127, velocity)), samplePosition);
+    return true;
+}
+
+bool MidiOutputStage::noteOff(int channel, int note, int samplePosition) noexcept {
+    if (!valid(channel, note)) return false;
+    uint8_t& count = holders_[key(channel, note)];
+    if (count == 0) return false;   // stolen or never sounded
+    if (--count > 0) return false;  // still held by someone else
+
+    queue(MidiNoteEvent::Type::NoteOff, channel, note, 0, samplePosition);
+    return true;
+}
+
+void MidiOutputStage::forceNoteOff(int channel, int note, int samplePosition) noexcept {
+    if (!valid(channel, note) || holders_[key(channel, note)] == 0) return;
+    holders_[key(channel, note)] = 0;
+    queue(MidiNoteEvent::Type::NoteOff, channel, note, 0, samplePosition);
+}
+
+void MidiOutputStage::allNotesOff(int samplePosition) noexcept {
+    for (int k = 0; k < NUM_KEYS; ++k) {
+        if (holders_[k] > 0) forceNoteOff(k >> 7, k & 127, samplePosition);
+    }
+}
+
+bool MidiOutputStage::isSounding(int channel, int note) const noexcept {
+    return valid(channel, note) && holders_[key(channel, note)] > 0;
+}
+
+int MidiOutputStage::getHolderCount(int channel, int note) const noexcept {
+    return valid(channel, note) ? holders_[key(channel, note)] : 0;
+}
+
+void MidiOutputStage::reset() noexcept {
+    holders_.fill(0);
+    numEvents_ = 0;
+    ++block_;
+}
+
+void MidiOutputStage::queue(MidiNoteEvent::Type type, int channel, int note,
+                            int velocity, int samplePosition) noexcept {
+    const int k = key(channel, note);
+
+    // Off then on (or on then off) for the same pitch at the same sample: drop both
+    if (lastEventBlock_[k] == block_) {
+        MidiNoteEvent& previous = events_[lastEvent_[k]];
+        if (previous.type != MidiNoteEvent::Type::None && previous.type != type &&
+            previous.samplePosition == samplePosition) {
+            previous.type = MidiNoteEvent::Type::None;
+            lastEventBlock_[k] = 0;
+            return;
+        }
+    }
+
+    if (numEvents_ >= MAX_EVENTS) {
+        ++droppedEvents_;
+        return;
+    }
+
+    MidiNoteEvent& e = events_[numEvents_];
+    e.type = type;
+    e.channel = static_cast<uint8_t>(channel);
+    e.note = static_cast<uint8_t>(note);
+    e.velocity = static_cast<uint8_t>(velocity);
+    e.samplePosition = samplePosition;
+    lastEvent_[k] = static_cast<int16_t>(numEvents_);
+    lastEventBlock_[k] = block_;
+    ++numEvents_;
+}
+
+} // namespace scalechord
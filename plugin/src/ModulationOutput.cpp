@@ -0,0 +1,53 @@
+#include "ModulationOutput.h"
+
+namespace scalechord {
+
+void ModulationOutput::setSettings(const ModulationSettings& s) noexcept {
+    const bool retarget = s.target != settings_.target;
+    settings_ = s;
+    settings_.threshold = std::max(1, std::min(127, settings_.threshold));
+    settings_.minIntervalMs = std::max(0.0f, settings_.minIntervalMs);
+    settings_.maxIntervalMs = std::max(settings_.minIntervalMs, settings_.maxIntervalMs);
+    updateIntervals();
+
+    // Destinations mean something else (channels vs voices) after a retarget
+    if (retarget) {
+        lastSent_.fill(-1);
+        sinceSent_.fill(0);
+    }
+}
+
+void ModulationOutput::setSampleRate(double sampleRate) noexcept {
+    if (sampleRate <= 0.0) return;
+    sampleRate_ = sampleRate;
+    updateIntervals();
+}
+
+void ModulationOutput::startVoice(int voice, int note, int channel) noexcept {
+    if (voice < 0 || voice >= MAX_VOICES || note < 0 || note > 127) return;
+    note_[voice] = static_cast<int8_t>(note);
+    channel_[voice] = static_cast<uint8_t>(std::max(0, std::min(15, channel)));
+    if (settings_.target == ModulationTarget::PolyAftertouch || settings_.target == ModulationTarget::MpePressure) {
+        lastSent_[voice] = -1;
+    }
+}
+
+void ModulationOutput::stopVoice(int voice) noexcept {
+    if (voice < 0 || voice >= MAX_VOICES) return;
+    note_[voice] = -1;
+}
+
+void ModulationOutput::reset() noexcept {
+    note_.fill(-1);
+    channel_.fill(0);
+    lastSent_.fill(-1);
+    sinceSent_.fill(0);
+    updateIntervals();
+}
+
+void ModulationOutput::updateIntervals() noexcept {
+    minIntervalSamples_ = static_cast<int32_t>(settings_.minIntervalMs * 0.001 * sampleRate_);
+    maxIntervalSamples_ = static_cast<int32_t>(settings_.maxIntervalMs * 0.001 * sampleRate_);
+}
+
+} // namespace scalechord
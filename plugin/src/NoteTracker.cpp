@@ -1,79 +1,181 @@
 // Note tracking implementation
 #include "NoteTracker.h"
-#include <algorithm>
 
 namespace scalechord {
 
-void NoteTracker::trackNoteOn(int inputNote, const std::vector<int>& generatedChord, 
+int OutputNoteSet::size() const noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(words_[0]) + __builtin_popcountll(words_[1]);
+#else
+    int n = 0;
+    for (uint64_t w : words_) {
+        for (; w; w &= w - 1) ++n;
+    }
+    return n;
+#endif
+}
+
+void OutputNoteSet::Iterator::advance() noexcept {
+    // Skip to the next set bit (or 128)
+    while (note_ < 128) {
+        uint64_t word = set_.words_[note_ >> 6] >> (note_ & 63);
+        if (word) {
+#if defined(__GNUC__) || defined(__clang__)
+            note_ += __builtin_ctzll(word);
+#else
+            while (!(word & 1u)) { word >>= 1; ++note_; }
+#endif
+            return;
+        }
+        note_ = (note_ | 63) + 1;
+    }
+}
+
+NoteTracker::NoteTracker() = default;
+
+void NoteTracker::trackNoteOn(int inputNote, const ChordBuffer& generatedChord,
+                               int velocity, int samplePosition) {
+    if (!validNote(inputNote)) return;
+    if (slots_[inputNote].active) release(inputNote);
+
+    Slot& slot = slots_[inputNote];
+    slot.note.inputNote = inputNote;
+    slot.note.generatedNotes.clear();
+    slot.note.velocity = velocity;
+    slot.note.samplePosition = samplePosition;
+    slot.note.envelopePhase = 0.0f;
+    slot.note.holdPedalActive = false;
+
+    for (int out : generatedChord) {
+        slot.note.generatedNotes.push_back(out);
+        if (!validNote(out)) continue;
+        if (outputRefCount_[out]++ == 0) outputNotes_.insert(out);
+    }
+
+    // Append to the active list
+    slot.active = true;
+    slot.prev = tail_;
+    slot.next = -1;
+    if (tail_ >= 0) slots_[tail_].next = static_cast<int8_t>(inputNote);
+    else head_ = static_cast<int8_t>(inputNote);
+    tail_ = static_cast<int8_t>(inputNote);
+    ++activeCount_;
+}
+
+void NoteTracker::trackNoteOn(int inputNote, const std::vector<int>& generatedChord,
                                int velocity, int samplePosition) {
-    ActiveNote note;
-    note.inputNote = inputNote;
-    note.generatedNotes = generatedChord;
-    note.velocity = velocity;
-    note.samplePosition = samplePosition;
-    note.envelopePhase = 0.0f;
-    
-    activeNotes_[inputNote] = note;
+    ChordBuffer chord;
+    for (int note : generatedChord) chord.push_back(note);
+    trackNoteOn(inputNote, chord, velocity, samplePosition);
 }
 
 void NoteTracker::trackNoteOff(int inputNote, int samplePosition) {
-    auto it = activeNotes_.find(inputNote);
-    if (it != activeNotes_.end()) {
-        if (sustainPedalActive_) {
-            // Keep note alive, mark for sustain
-            it->second.holdPedalActive = true;
-            releasedButSustainedNotes_.push_back(inputNote);
-        } else {
-            activeNotes_.erase(it);
+    (void)samplePosition;
+    if (!validNote(inputNote) || !slots_[inputNote].active) return;
+
+    Slot& slot = slots_[inputNote];
+    if (sustainPedalActive_) {
+        // Keep note alive, mark for sustain
+        if (!slot.note.holdPedalActive) {
+            slot.note.holdPedalActive = true;
+            ++sustainedCount_;
         }
+    } else {
+        release(inputNote);
     }
 }
 
-std::vector<int> NoteTracker::getAllActiveGeneratedNotes() const {
-    std::vector<int> result;
-    for (const auto& pair : activeNotes_) {
-        for (int note : pair.second.generatedNotes) {
-            result.push_back(note);
+void NoteTracker::removeOutputNote(int outputNote) noexcept {
+    if (!validNote(outputNote) || outputRefCount_[outputNote] == 0) return;
+
+    for (int8_t i = head_; i >= 0; i = slots_[i].next) {
+        ChordBuffer& chord = slots_[i].note.generatedNotes;
+        int kept = 0;
+        for (int note : chord) {
+            if (note != outputNote) chord[kept++] = note;
         }
+        while (chord.size() > kept) chord.pop_back();
+    }
+    outputRefCount_[outputNote] = 0;
+    outputNotes_.erase(outputNote);
+}
+
+void NoteTracker::release(int inputNote) noexcept {
+    Slot& slot = slots_[inputNote];
+
+    for (int out : slot.note.generatedNotes) {
+        if (!validNote(out) || outputRefCount_[out] == 0) continue;
+        if (--outputRefCount_[out] == 0) outputNotes_.erase(out);
     }
-    std::sort(result.begin(), result.end());
-    result.erase(std::unique(result.begin(), result.end()), result.end());
+    if (slot.note.holdPedalActive) --sustainedCount_;
+
+    // Unlink from the active list
+    if (slot.prev >= 0) slots_[slot.prev].next = slot.next;
+    else head_ = slot.next;
+    if (slot.next >= 0) slots_[slot.next].prev = slot.prev;
+    else tail_ = slot.prev;
+
+    slot.active = false;
+    slot.prev = slot.next = -1;
+    --activeCount_;
+}
+
+std::vector<int> NoteTracker::getAllActiveGeneratedNotes() const {
+    // The bitmap iterates in ascending order with no duplicates
+    std::vector<int> result;
+    result.reserve(outputNotes_.size());
+    for (int note : outputNotes_) result.push_back(note);
     return result;
 }
 
+int NoteTracker::getOutputNoteRefCount(int outputNote) const noexcept {
+    return validNote(outputNote) ? outputRefCount_[outputNote] : 0;
+}
+
 std::vector<int> NoteTracker::getNoteOffsForInputNote(int inputNote) const {
-    auto it = activeNotes_.find(inputNote);
-    if (it != activeNotes_.end()) {
-        return it->second.generatedNotes;
-    }
-    return {};
+    const ChordBuffer* notes = getGeneratedNotes(inputNote);
+    return notes ? notes->toVector() : std::vector<int>{};
+}
+
+const ChordBuffer* NoteTracker::getGeneratedNotes(int inputNote) const noexcept {
+    if (!validNote(inputNote) || !slots_[inputNote].active) return nullptr;
+    return &slots_[inputNote].note.generatedNotes;
 }
 
 bool NoteTracker::isNotePlaying(int inputNote) const {
-    return activeNotes_.find(inputNote) != activeNotes_.end();
+    return validNote(inputNote) && slots_[inputNote].active;
 }
 
 void NoteTracker::reset() {
-    activeNotes_.clear();
-    releasedButSustainedNotes_.clear();
+    for (Slot& slot : slots_) {
+        slot.active = false;
+        slot.prev = slot.next = -1;
+    }
+    head_ = tail_ = -1;
+    activeCount_ = 0;
+    sustainedCount_ = 0;
+    outputRefCount_.fill(0);
+    outputNotes_.clear();
 }
 
 void NoteTracker::updateEnvelopes(float sampleRate) {
     (void)sampleRate;  // For future envelope update logic
-    
+
     // Remove sustained notes if pedal is released
-    if (!sustainPedalActive_) {
-        for (int inputNote : releasedButSustainedNotes_) {
-            activeNotes_.erase(inputNote);
+    if (!sustainPedalActive_ && sustainedCount_ > 0) {
+        for (int i = head_; i >= 0;) {
+            int next = slots_[i].next;
+            if (slots_[i].note.holdPedalActive) release(i);
+            i = next;
         }
-        releasedButSustainedNotes_.clear();
     }
 }
 
 std::vector<ActiveNote> NoteTracker::getActiveNotes() const {
     std::vector<ActiveNote> result;
-    for (const auto& pair : activeNotes_) {
-        result.push_back(pair.second);
+    result.reserve(activeCount_);
+    for (int i = head_; i >= 0; i = slots_[i].next) {
+        result.push_back(slots_[i].note);
     }
     return result;
 }
@@ -62,6 +62,10 @@ void PerformanceDashboard::updateVoiceMetrics(int activeVoiceCount, const bool v
     voiceHistory[historyIndex] = static_cast<float>(activeVoiceCount);
 }
 
+void PerformanceDashboard::updateVoiceSteals(int totalSteals) {
+    voiceMetrics.stealCount = std::max(0, totalSteals);
+}
+
 void PerformanceDashboard::updateCPUMetrics(float cpuPercentage, float blockTimeMs) {
     cpuPercentage = std::max(0.0f, std::min(cpuPercentage, 100.0f));
     
@@ -315,8 +319,11 @@ float PerformanceDashboard::getUptime() const {
 
 std::string PerformanceDashboard::getStatusString() const {
     std::ostringstream oss;
-    oss << "Voices: " << voiceMetrics.activeVoiceCount << "/" << MAX_VOICES << " | "
-        << "CPU: " << std::fixed << std::setprecision(1) << cpuMetrics.currentCPU << "% | "
+    oss << "Voices: " << voiceMetrics.activeVoiceCount << "/" << MAX_VOICES << " | ";
+    if (voiceMetrics.stealCount > 0) {
+        oss << "Stolen: " << voiceMetrics.stealCount << " | ";
+    }
+    oss << "CPU: " << std::fixed << std::setprecision(1) << cpuMetrics.currentCPU << "% | "
         << "Latency: " << latencyMetrics.midiLatencyMs << " ms";
     
     if (audioMetrics.isClipping) {
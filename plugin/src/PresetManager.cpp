@@ -436,7 +436,8 @@ std::string PresetManager::presetToJson(const Preset& preset) {
     oss << "    \"humanizerEnabled\": " << (preset.midiEffects.humanizerEnabled ? "true" : "false") << ",\n";
     oss << "    \"humanizerMode\": " << preset.midiEffects.humanizerMode << ",\n";
     oss << "    \"probabilityEnabled\": " << (preset.midiEffects.probabilityEnabled ? "true" : "false") << ",\n";
-    oss << "    \"probabilityAmount\": " << preset.midiEffects.probabilityAmount << "\n";
+    oss << "    \"probabilityAmount\": " << preset.midiEffects.probabilityAmount << ",\n";
+    oss << "    \"randomSeed\": " << preset.midiEffects.randomSeed << "\n";
     oss << "  }\n";
     oss << "}\n";
     
@@ -532,6 +533,7 @@ bool PresetManager::jsonToPreset(const std::string& json, Preset& outPreset) {
         outPreset.midiEffects.humanizerMode = extractInt("humanizerMode");
         outPreset.midiEffects.probabilityEnabled = extractBool("probabilityEnabled");
         outPreset.midiEffects.probabilityAmount = extractFloat("probabilityAmount");
+        outPreset.midiEffects.randomSeed = extractInt("randomSeed");
         
         return true;
     } catch (...) {
@@ -0,0 +1,315 @@
+#include "ProgressionReharmonizer.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+constexpr int MAJOR_SCALE[7] = {0, 2, 4, 5, 7, 9, 11};
+constexpr int MINOR_SCALE[7] = {0, 2, 3, 5, 7, 8, 10};
+
+scalechord::PitchClassSet keyScale(int keyRoot, bool majorKey)
+{
+    scalechord::PitchClassSet scale;
+    for (int interval : majorKey ? MAJOR_SCALE : MINOR_SCALE) scale.insert(keyRoot + interval);
+    return scale;
+}
+
+// Scale degree (0-6) of a pitch class, -1 if it is not in the key
+int scaleDegree(int pitchClass, int keyRoot, bool majorKey)
+{
+    const int* scale = majorKey ? MAJOR_SCALE : MINOR_SCALE;
+    int interval = scalechord::PitchClassSet::wrap(pitchClass - keyRoot);
+    for (int d = 0; d < 7; ++d) {
+        if (scale[d] == interval) return d;
+    }
+    return -1;
+}
+
+scalechord::PitchClassSet keyPitches(uint16_t chordKey)
+{
+    return scalechord::PitchClassSet(static_cast<uint16_t>(chordKey & scalechord::PitchClassSet::FULL_MASK));
+}
+
+int keyRoot(uint16_t chordKey)
+{
+    return chordKey >> 12;
+}
+
+uint16_t makeChordKey(scalechord::PitchClassSet pitches, int root)
+{
+    return static_cast<uint16_t>(pitches.mask() | (root << 12));
+}
+
+} // namespace
+
+ProgressionReharmonizer::ProgressionReharmonizer()
+    : realtimeCache_(std::make_unique<TransitionCache>())
+{
+}
+
+ProgressionReharmonizer::ProgressionReharmonizer(const ReharmonizerSettings& settings)
+    : ProgressionReharmonizer()
+{
+    setSettings(settings);
+}
+
+void ProgressionReharmonizer::setSettings(const ReharmonizerSettings& settings)
+{
+    // The memo key covers the key and mode only: new weights make every
+    // stored transition stale
+    if (settings.musicalityWeight != settings_.musicalityWeight ||
+        settings.originalMusicality != settings_.originalMusicality ||
+        settings.smoothnessWeight != settings_.smoothnessWeight ||
+        settings.resolutionBonus != settings_.resolutionBonus ||
+        settings.outOfKeyPenalty != settings_.outOfKeyPenalty) {
+        std::fill(std::begin(realtimeCache_->entries), std::end(realtimeCache_->entries), TransitionCache::Entry{});
+    }
+
+    settings_ = settings;
+    settings_.keyRoot = scalechord::PitchClassSet::wrap(settings_.keyRoot);
+    settings_.beamWidth = std::max(1, settings_.beamWidth);
+}
+
+int ProgressionReharmonizer::canonicalVoicing(uint16_t chordKey, int* out)
+{
+    // Closed, root position, root in octave 4
+    const scalechord::PitchClassSet pitches = keyPitches(chordKey);
+    const int root = keyRoot(chordKey);
+    int count = 0;
+    for (int interval = 0; interval < 12; ++interval) {
+        if (pitches.contains(root + interval)) out[count++] = 60 + root + interval;
+    }
+    return count;
+}
+
+int ProgressionReharmonizer::buildOptions(const int* notes, int numNotes, Option* out) const
+{
+    scalechord::PitchClassSet written;
+    for (int i = 0; i < numNotes; ++i) written.insert(notes[i]);
+    if (written.empty()) {
+        out[0] = {nullptr, 0, 0.0f};  // rest
+        return 1;
+    }
+
+    const scalechord::PitchClassSet scale = keyScale(settings_.keyRoot, settings_.majorKey);
+    auto outOfKey = [&](scalechord::PitchClassSet pitches) {
+        return settings_.outOfKeyPenalty * (pitches & scalechord::PitchClassSet(static_cast<uint16_t>(~scale.mask()))).size();
+    };
+
+    ChordMatch match = ChordAnalyzer::matchPitchClasses(written);
+    int root = match.confidence > 0.0f ? match.rootOffset
+                                       : scalechord::PitchClassSet::wrap(*std::min_element(notes, notes + numNotes));
+    const uint16_t writtenKey = makeChordKey(written, root);
+
+    int count = 0;
+    out[count++] = {nullptr, writtenKey, settings_.musicalityWeight * settings_.originalMusicality - outOfKey(written)};
+
+    const int degree = scaleDegree(root, settings_.keyRoot, settings_.majorKey);
+    if (degree < 0) return count;  // chromatic chord: keep as written
+
+    for (const Substitution& sub : jazz_.getSubstitutions(degree, settings_.majorKey)) {
+        if (count == MAX_OPTIONS) break;
+
+        int subRoot = scalechord::PitchClassSet::wrap(root + sub.rootOffset);
+        scalechord::PitchClassSet pitches = ChordAnalyzer::qualityPitchClasses(sub.substituteQuality);
+        if (sub.kind == SubstitutionKind::UpperStructure) {
+            // Dominant on the written root, major triad rootOffset above it
+            subRoot = root;
+            pitches = pitches | ChordAnalyzer::qualityPitchClasses(ChordQuality::Major).rotate(sub.rootOffset);
+        }
+        pitches = pitches.rotate(subRoot);
+
+        const uint16_t chordKey = makeChordKey(pitches, subRoot);
+        if (pitches.empty() || chordKey == writtenKey) continue;
+        out[count++] = {&sub, chordKey, settings_.musicalityWeight * sub.musicality - outOfKey(pitches)};
+    }
+    return count;
+}
+
+float ProgressionReharmonizer::transition(uint16_t previousKey, uint16_t chordKey, TransitionCache& cache) const
+{
+    if (keyPitches(previousKey).empty() || keyPitches(chordKey).empty()) return 0.0f;
+
+    const uint64_t key = (static_cast<uint64_t>(settings_.keyRoot + (settings_.majorKey ? 12 : 0) + 1) << 32) |
+                         (static_cast<uint64_t>(previousKey) << 16) | chordKey;
+    TransitionCache::Entry& entry = cache.entries[(key * 0x9E3779B97F4A7C15ull) >> 52];
+    if (entry.key == key) return entry.value;
+
+    // Smoothness of the canonical previous voicing into the best voicing of this chord
+    int from[12], target[12], voiced[12];
+    const int numFrom = canonicalVoicing(previousKey, from);
+    const int numTarget = canonicalVoicing(chordKey, target);
+    float smoothness = 50.0f;  // neutral for chords too large to score in one batch row
+    if (numFrom <= VoiceLeading::BATCH_WIDTH && numTarget <= VoiceLeading::BATCH_WIDTH) {
+        const int numVoiced = voiceLeading_.optimizeVoicing(from, numFrom, target, numTarget, voiced, 2);
+        int8_t row[VoiceLeading::BATCH_WIDTH];
+        for (int v = 0; v < VoiceLeading::BATCH_WIDTH; ++v) row[v] = static_cast<int8_t>(v < numVoiced ? voiced[v] : -1);
+        voiceLeading_.scoreVoiceLeadingBatch(from, numFrom, row, 1, &smoothness);
+    }
+    float value = settings_.smoothnessWeight * smoothness;
+
+    // Dominant (major 3rd + minor 7th) resolving down a fifth or a half step
+    const int previousRoot = keyRoot(previousKey);
+    const int root = keyRoot(chordKey);
+    const scalechord::PitchClassSet previousPitches = keyPitches(previousKey);
+    const bool dominant = previousPitches.contains(previousRoot + 4) && previousPitches.contains(previousRoot + 10);
+    const int motion = scalechord::PitchClassSet::wrap(root - previousRoot);
+    if (dominant && (motion == 5 || motion == 11) && scaleDegree(root, settings_.keyRoot, settings_.majorKey) >= 0) {
+        value += settings_.resolutionBonus;
+    }
+
+    entry.key = key;
+    entry.value = value;
+    return value;
+}
+
+int ProgressionReharmonizer::voiceOption(
+    const Option& option, const int* written, int numWritten,
+    const int* previous, int numPrevious, int* out) const
+{
+    if (option.substitution == nullptr) {
+        const int count = std::min(numWritten, MAX_NOTES);
+        std::copy(written, written + count, out);
+        std::sort(out, out + count);
+        return count;
+    }
+
+    int target[12];
+    const int numTarget = canonicalVoicing(option.chordKey, target);
+    if (numPrevious <= 0) {
+        previous = written;
+        numPrevious = numWritten;
+    }
+    return voiceLeading_.optimizeVoicing(previous, numPrevious, target, numTarget, out, 2);
+}
+
+float ProgressionReharmonizer::reharmonizeSection(
+    const std::vector<TimelineChord>& timeline, size_t begin, size_t end,
+    TransitionCache& cache, std::vector<ReharmonizedChord>& out) const
+{
+    if (begin >= end) return 0.0f;
+
+    struct State {
+        float score;
+        int option;
+        int parent;   // index into the previous chord's beam
+    };
+
+    const size_t length = end - begin;
+    std::vector<Option> options(length * MAX_OPTIONS);
+    std::vector<int> numOptions(length);
+    std::vector<std::vector<State>> beams(length);
+    auto byScore = [](const State& a, const State& b) { return a.score > b.score; };
+
+    for (size_t t = 0; t < length; ++t) {
+        const std::vector<int>& notes = timeline[begin + t].notes;
+        Option* current = &options[t * MAX_OPTIONS];
+        numOptions[t] = buildOptions(notes.data(), static_cast<int>(notes.size()), current);
+
+        // Best path into each option (the future only depends on the last
+        // chord), then the beamWidth best of those
+        State best[MAX_OPTIONS];
+        for (int o = 0; o < numOptions[t]; ++o) best[o] = {t == 0 ? current[o].score : -std::numeric_limits<float>::max(), o, -1};
+
+        if (t > 0) {
+            const Option* previous = &options[(t - 1) * MAX_OPTIONS];
+            for (int p = 0; p < static_cast<int>(beams[t - 1].size()); ++p) {
+                const State& parent = beams[t - 1][p];
+                for (int o = 0; o < numOptions[t]; ++o) {
+                    float score = parent.score + current[o].score +
+                                  transition(previous[parent.option].chordKey, current[o].chordKey, cache);
+                    if (score > best[o].score) best[o] = {score, o, p};
+                }
+            }
+        }
+
+        std::vector<State>& beam = beams[t];
+        beam.assign(best, best + numOptions[t]);
+        std::sort(beam.begin(), beam.end(), byScore);
+        if (static_cast<int>(beam.size()) > settings_.beamWidth) beam.resize(settings_.beamWidth);
+    }
+
+    // Walk back the best path, then voice it forward
+    std::vector<int> chosen(length);
+    for (int t = static_cast<int>(length) - 1, index = 0; t >= 0; --t) {
+        chosen[t] = beams[t][index].option;
+        index = beams[t][index].parent;
+    }
+
+    int previous[MAX_NOTES];
+    int numPrevious = 0;
+    for (size_t t = 0; t < length; ++t) {
+        const TimelineChord& chord = timeline[begin + t];
+        const Option& option = options[t * MAX_OPTIONS + chosen[t]];
+        int voiced[MAX_NOTES];
+        int count = voiceOption(option, chord.notes.data(), static_cast<int>(chord.notes.size()),
+                                previous, numPrevious, voiced);
+
+        ReharmonizedChord& result = out[begin + t];
+        result.ppq = chord.ppq;
+        result.notes.assign(voiced, voiced + count);
+        result.substitution = option.substitution;
+
+        if (count > 0) {  // rests keep the previous chord as the voicing source
+            std::copy(voiced, voiced + count, previous);
+            numPrevious = count;
+        }
+    }
+    return beams[length - 1][0].score;
+}
+
+ReharmonizationResult ProgressionReharmonizer::reharmonize(const std::vector<TimelineChord>& timeline) const
+{
+    ReharmonizationResult result;
+    result.chords.resize(timeline.size());
+    if (timeline.empty()) return result;
+
+    std::vector<size_t> sectionStarts{0};
+    for (size_t i = 1; i < timeline.size(); ++i) {
+        if (timeline[i].sectionStart) sectionStarts.push_back(i);
+    }
+    sectionStarts.push_back(timeline.size());
+    const size_t numSections = sectionStarts.size() - 1;
+    std::vector<float> sectionScore(numSections, 0.0f);
+
+    // Each worker has its own memo table and writes only its sections' slots
+    scalechord::runParallel(numSections, settings_.maxThreads, [&]() {
+        return [&, cache = std::make_unique<TransitionCache>()](size_t s) {
+            sectionScore[s] = reharmonizeSection(timeline, sectionStarts[s], sectionStarts[s + 1], *cache, result.chords);
+        };
+    });
+
+    for (float score : sectionScore) result.totalScore += score;
+    result.sectionCount = static_cast<int>(numSections);
+    return result;
+}
+
+int ProgressionReharmonizer::nextChord(const int* notes, int numNotes, int* out, const Substitution** chosen)
+{
+    if (chosen) *chosen = nullptr;
+    if (numNotes <= 0) return 0;
+
+    Option options[MAX_OPTIONS];
+    const int numOptions = buildOptions(notes, numNotes, options);
+
+    int best = 0;
+    float bestScore = -std::numeric_limits<float>::max();
+    for (int o = 0; o < numOptions; ++o) {
+        float score = options[o].score;
+        if (numPrevious_ > 0) score += transition(previousKey_, options[o].chordKey, *realtimeCache_);
+        if (score > bestScore) {
+            bestScore = score;
+            best = o;
+        }
+    }
+
+    const int count = voiceOption(options[best], notes, numNotes, previousNotes_, numPrevious_, out);
+    if (chosen) *chosen = options[best].substitution;
+
+    previousKey_ = options[best].chordKey;
+    std::copy(out, out + count, previousNotes_);
+    numPrevious_ = count;
+    return count;
+}
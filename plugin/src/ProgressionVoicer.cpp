@@ -0,0 +1,265 @@
+#include "ProgressionVoicer.h"
+#include "Parallel.h"
+#include "PitchClassSet.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int ANY_BASS = 15;  // bass nibble of a key when keepBass is off
+
+uint16_t makeKey(scalechord::PitchClassSet pitches, int bass)
+{
+    return static_cast<uint16_t>(pitches.mask() | (bass << 12));
+}
+
+} // namespace
+
+ProgressionVoicer::ProgressionVoicer(const ProgressionVoicerSettings& settings)
+{
+    setSettings(settings);
+}
+
+void ProgressionVoicer::setSettings(const ProgressionVoicerSettings& settings)
+{
+    settings_ = settings;
+    settings_.candidatesPerChord = std::max(1, std::min(MAX_CANDIDATES, settings_.candidatesPerChord));
+    settings_.lowestNote = std::max(0, std::min(127, settings_.lowestNote));
+    settings_.highestNote = std::max(settings_.lowestNote, std::min(127, settings_.highestNote));
+    settings_.segmentLength = std::max(0, settings_.segmentLength);
+}
+
+uint16_t ProgressionVoicer::chordKey(const std::vector<int>& chord) const
+{
+    if (chord.empty()) return 0;
+
+    scalechord::PitchClassSet pitches = scalechord::PitchClassSet::fromNotes(chord);
+    int bass = scalechord::PitchClassSet::wrap(*std::min_element(chord.begin(), chord.end()));
+
+    // Drop the highest pitch classes above the bass beyond MAX_NOTES
+    while (pitches.size() > MAX_NOTES) {
+        for (int step = 11; step > 0; --step) {
+            int pitch = (bass + step) % 12;
+            if (pitches.contains(pitch)) {
+                pitches.erase(pitch);
+                break;
+            }
+        }
+    }
+    return makeKey(pitches, settings_.keepBass ? bass : ANY_BASS);
+}
+
+float ProgressionVoicer::staticCost(const Voicing& v) const
+{
+    float cost = 0.0f;
+    if (v.size > 0 && v.notes[v.size - 1] > settings_.highestNote) {
+        cost += settings_.rangePenalty * (v.notes[v.size - 1] - settings_.highestNote);
+    }
+    for (int i = 1; i < v.size; ++i) {
+        int gap = v.notes[i] - v.notes[i - 1];
+        if (gap > settings_.maxSpacing) cost += settings_.spacingPenalty * (gap - settings_.maxSpacing);
+    }
+    return cost;
+}
+
+float ProgressionVoicer::movement(const Voicing& from, const Voicing& to)
+{
+    if (from.size == 0 || to.size == 0) return 0.0f;
+
+    // Monotone alignment of the two sorted chords: every note is tied to at
+    // least one note of the other chord, so voices may split or merge when
+    // the sizes differ. For equal sizes the cheapest path is the one-to-one
+    // (sorted) matching.
+    int d[MAX_NOTES][MAX_NOTES];
+    for (int i = 0; i < from.size; ++i) {
+        for (int j = 0; j < to.size; ++j) {
+            int step = std::abs(from.notes[i] - to.notes[j]);
+            if (i == 0 && j == 0) d[i][j] = step;
+            else if (i == 0) d[i][j] = step + d[i][j - 1];
+            else if (j == 0) d[i][j] = step + d[i - 1][j];
+            else d[i][j] = step + std::min({d[i - 1][j - 1], d[i - 1][j], d[i][j - 1]});
+        }
+    }
+    return static_cast<float>(d[from.size - 1][to.size - 1]);
+}
+
+const std::vector<ProgressionVoicer::Voicing>& ProgressionVoicer::candidatesFor(
+    uint16_t key, Cache& cache) const
+{
+    auto found = cache.candidates.find(key);
+    if (found != cache.candidates.end()) return found->second;
+
+    std::vector<Voicing>& kept = cache.candidates[key];
+    scalechord::PitchClassSet pitches(static_cast<uint16_t>(key & scalechord::PitchClassSet::FULL_MASK));
+    if (pitches.empty()) {
+        kept.push_back(Voicing{});  // rest
+        return kept;
+    }
+
+    const int fixedBass = key >> 12;
+    std::vector<Voicing> all;
+    for (int bass : pitches) {
+        if (fixedBass != ANY_BASS && bass != fixedBass) continue;
+
+        // Intervals of the other pitch classes above the bass, ascending
+        int intervals[MAX_NOTES];
+        int numIntervals = 0;
+        for (int step = 1; step < 12; ++step) {
+            if (pitches.contains(bass + step)) intervals[numIntervals++] = step;
+        }
+
+        // Lowest bass at or above lowestNote; always at least one (narrow ranges)
+        int firstBass = settings_.lowestNote + (bass - settings_.lowestNote % 12 + 12) % 12;
+        if (firstBass > 127) firstBass -= 12;
+        for (int bassNote = firstBass; bassNote == firstBass || bassNote <= settings_.highestNote; bassNote += 12) {
+            // Each upper pitch class in the first or second octave above the bass
+            for (int octaves = 0; octaves < (1 << numIntervals); ++octaves) {
+                Voicing v;
+                v.notes[v.size++] = static_cast<int8_t>(bassNote);
+                bool valid = true;
+                for (int i = 0; i < numIntervals; ++i) {
+                    int note = bassNote + intervals[i] + ((octaves >> i) & 1) * 12;
+                    if (note > 127) {
+                        valid = false;
+                        break;
+                    }
+                    v.notes[v.size++] = static_cast<int8_t>(note);
+                }
+                if (!valid) continue;
+                std::sort(v.notes.begin(), v.notes.begin() + v.size);
+                v.cost = staticCost(v);
+                all.push_back(v);
+            }
+        }
+    }
+
+    // K best by penalty, ties toward the center register
+    const int center = settings_.centerNote;
+    auto registerDistance = [center](const Voicing& v) {
+        int sum = 0;
+        for (int i = 0; i < v.size; ++i) sum += v.notes[i];
+        return std::abs(sum - center * v.size) / static_cast<float>(v.size);
+    };
+    const size_t k = std::min(all.size(), static_cast<size_t>(settings_.candidatesPerChord));
+    std::partial_sort(all.begin(), all.begin() + k, all.end(), [&](const Voicing& a, const Voicing& b) {
+        if (a.cost != b.cost) return a.cost < b.cost;
+        return registerDistance(a) < registerDistance(b);
+    });
+    kept.assign(all.begin(), all.begin() + k);
+    return kept;
+}
+
+const std::vector<float>& ProgressionVoicer::transitionsFor(
+    uint16_t from, uint16_t to, Cache& cache) const
+{
+    const uint32_t pairKey = (static_cast<uint32_t>(from) << 16) | to;
+    auto found = cache.transitions.find(pairKey);
+    if (found != cache.transitions.end()) return found->second;
+
+    // Candidate vectors are never erased, so these references stay valid
+    const std::vector<Voicing>& a = candidatesFor(from, cache);
+    const std::vector<Voicing>& b = candidatesFor(to, cache);
+    std::vector<float>& table = cache.transitions[pairKey];
+    table.resize(a.size() * b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t j = 0; j < b.size(); ++j) {
+            table[i * b.size() + j] = settings_.movementWeight * movement(a[i], b[j]);
+        }
+    }
+    return table;
+}
+
+float ProgressionVoicer::optimizeSegment(
+    const std::vector<uint16_t>& keys, size_t begin, size_t end,
+    Cache& cache, std::vector<std::vector<int>>& out) const
+{
+    if (begin >= end) return 0.0f;
+
+    const size_t length = end - begin;
+    std::vector<float> cost(length * MAX_CANDIDATES);
+    std::vector<int8_t> back(length * MAX_CANDIDATES);
+
+    const std::vector<Voicing>* current = &candidatesFor(keys[begin], cache);
+    for (size_t j = 0; j < current->size(); ++j) cost[j] = (*current)[j].cost;
+
+    for (size_t t = 1; t < length; ++t) {
+        const std::vector<Voicing>& previous = *current;
+        current = &candidatesFor(keys[begin + t], cache);
+        const std::vector<float>& table = transitionsFor(keys[begin + t - 1], keys[begin + t], cache);
+        const float* prevCost = &cost[(t - 1) * MAX_CANDIDATES];
+        const size_t width = current->size();
+
+        for (size_t j = 0; j < width; ++j) {
+            float best = std::numeric_limits<float>::max();
+            int8_t bestFrom = 0;
+            for (size_t i = 0; i < previous.size(); ++i) {
+                float c = prevCost[i] + table[i * width + j];
+                if (c < best) {
+                    best = c;
+                    bestFrom = static_cast<int8_t>(i);
+                }
+            }
+            cost[t * MAX_CANDIDATES + j] = best + (*current)[j].cost;
+            back[t * MAX_CANDIDATES + j] = bestFrom;
+        }
+    }
+
+    // Cheapest final candidate, then walk the back pointers
+    const float* lastCost = &cost[(length - 1) * MAX_CANDIDATES];
+    const size_t lastWidth = candidatesFor(keys[end - 1], cache).size();
+    int choice = static_cast<int>(std::min_element(lastCost, lastCost + lastWidth) - lastCost);
+    const float total = lastCost[choice];
+
+    for (size_t t = length; t-- > 0;) {
+        const Voicing& v = candidatesFor(keys[begin + t], cache)[choice];
+        out[begin + t].assign(v.notes.begin(), v.notes.begin() + v.size);
+        choice = back[t * MAX_CANDIDATES + choice];
+    }
+    return total;
+}
+
+ProgressionVoicingResult ProgressionVoicer::optimize(const std::vector<std::vector<int>>& chords) const
+{
+    ProgressionVoicingResult result;
+    result.voicings.resize(chords.size());
+    if (chords.empty()) return result;
+
+    std::vector<uint16_t> keys(chords.size());
+    for (size_t i = 0; i < chords.size(); ++i) keys[i] = chordKey(chords[i]);
+
+    const size_t segmentLength = settings_.segmentLength > 0 ? static_cast<size_t>(settings_.segmentLength) : chords.size();
+    const size_t numSegments = (chords.size() + segmentLength - 1) / segmentLength;
+    std::vector<float> segmentCost(numSegments, 0.0f);
+
+    // Each worker has its own memo tables and writes only its segments' slots
+    scalechord::runParallel(numSegments, settings_.maxThreads, [&]() {
+        return [&, cache = Cache()](size_t s) mutable {
+            size_t begin = s * segmentLength;
+            size_t end = std::min(chords.size(), begin + segmentLength);
+            segmentCost[s] = optimizeSegment(keys, begin, end, cache, result.voicings);
+        };
+    });
+
+    for (float c : segmentCost) result.totalCost += c;
+    result.segmentCount = static_cast<int>(numSegments);
+    return result;
+}
+
+float ProgressionVoicer::scoreVoicings(const std::vector<std::vector<int>>& voicings) const
+{
+    float total = 0.0f;
+    Voicing previous;
+    for (const std::vector<int>& chord : voicings) {
+        Voicing v;
+        for (int note : chord) {
+            if (v.size == MAX_NOTES) break;
+            v.notes[v.size++] = static_cast<int8_t>(std::max(0, std::min(127, note)));
+        }
+        std::sort(v.notes.begin(), v.notes.begin() + v.size);
+        v.cost = staticCost(v);
+        total += v.cost + settings_.movementWeight * movement(previous, v);
+        previous = v;
+    }
+    return total;
+}
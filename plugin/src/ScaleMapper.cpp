@@ -1,132 +1,49 @@
 #include "ScaleMapper.h"
+#include "ScaleTables.h"
+
 #include <algorithm>
-#include <stdexcept>
+
+// x86 SIMD paths are compiled with per-function target attributes and picked
+// at runtime, so they do not depend on the build's -m flags
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SCALECHORD_X86_DISPATCH 1
+#include <immintrin.h>
+#else
+#define SCALECHORD_X86_DISPATCH 0
+#endif
 
 namespace scalechord {
 
-static std::vector<int> semitones_for_scale(ScaleType t) {
-    switch (t) {
-        // Major scale modes (Ionian mode = Major)
-        case ScaleType::Ionian:
-            return {0,2,4,5,7,9,11};
-        
-        case ScaleType::Dorian:
-            return {0,2,3,5,7,9,10};
-        
-        case ScaleType::Phrygian:
-            return {0,1,3,5,7,8,10};
-        
-        case ScaleType::Lydian:
-            return {0,2,4,6,7,9,11};
-        
-        case ScaleType::Mixolydian:
-            return {0,2,4,5,7,9,10};
-        
-        case ScaleType::Aeolian:
-            return {0,2,3,5,7,8,10};  // Natural minor
-        
-        case ScaleType::Locrian:
-            return {0,1,3,5,6,8,10};
-        
-        // Minor scale variants
-        case ScaleType::HarmonicMinor:
-            return {0,2,3,5,7,8,11};  // Minor with raised 7th
-        
-        case ScaleType::MelodicMinor:
-            return {0,2,3,5,7,9,11};  // Minor with raised 6th & 7th
-        
-        // Pentatonic
-        case ScaleType::MajorPentatonic:
-            return {0,2,4,7,9};
-        
-        case ScaleType::MinorPentatonic:
-            return {0,3,5,7,10};
-        
-        // Blues
-        case ScaleType::MajorBlues:
-            return {0,2,3,4,7,9};  // Major pentatonic + flat 5
-        
-        case ScaleType::MinorBlues:
-            return {0,3,5,6,7,10};  // Minor pentatonic + flat 5
-        
-        // Other scales
-        case ScaleType::WholeTone:
-            return {0,2,4,6,8,10};  // All whole steps
-        
-        case ScaleType::Diminished:
-            return {0,2,3,5,6,8,9,11};  // Whole-half diminished
-        
-        default:
-            return {0,2,4,5,7,9,11};  // Default to Ionian/Major
-    }
+ScaleMapper::ScaleMapper()
+    : table_(&scaleTable(ScaleType::Ionian, 0))
+{
 }
 
 ScaleMapper::ScaleMapper(const MapperSettings& s)
-    : settings_(s)
+    : table_(&scaleTable(s.scale, s.rootNote))
 {
-    rebuildScale();
 }
 
 void ScaleMapper::setSettings(const MapperSettings& s) {
-    settings_ = s;
-    lookupTableValid_ = false;  // Invalidate lookup table
-    rebuildScale();
+    // Static tables never go away, so publishing is a single pointer store
+    table_.store(&scaleTable(s.scale, s.rootNote), std::memory_order_release);
 }
 
-MapperSettings ScaleMapper::getSettings() const noexcept { return settings_; }
-
-void ScaleMapper::rebuildScale() {
-    auto base = semitones_for_scale(settings_.scale);
-    scaleSemitones_.clear();
-    for (int st : base) {
-        // normalize within 0..11
-        int v = (settings_.rootNote + st) % 12;
-        if (v < 0) v += 12;
-        scaleSemitones_.push_back(v);
-    }
-    std::sort(scaleSemitones_.begin(), scaleSemitones_.end());
+MapperSettings ScaleMapper::getSettings() const noexcept {
+    const ScaleTable& table = getScaleTable();
+    MapperSettings s;
+    s.rootNote = table.rootNote;
+    s.scale = table.scale;
+    return s;
 }
 
 std::vector<int> ScaleMapper::getScaleSemitones() const {
-    return scaleSemitones_;
-}
-
-int ScaleMapper::quantizeToScale(int midiNote) const {
-    if (midiNote < 0) midiNote = 0;
-    if (midiNote > 127) midiNote = 127;
-
-    int octave = midiNote / 12;
-    int noteInOctave = midiNote % 12;
-
-    // find nearest scale degree (in semitones) in this octave, but allow mapping up/down one octave
-    int bestNote = octave * 12 + scaleSemitones_[0];
-    int bestDist = 1000;
-    for (int o = -1; o <= 1; ++o) {
-        for (int degree : scaleSemitones_) {
-            int candidate = (octave + o) * 12 + degree;
-            if (candidate < 0 || candidate > 127) continue;
-            int dist = std::abs(candidate - midiNote);
-            if (dist < bestDist) {
-                bestDist = dist;
-                bestNote = candidate;
-            }
-        }
-    }
-    return bestNote;
+    const ScaleTable& table = getScaleTable();
+    return std::vector<int>(table.semitones.begin(), table.semitones.begin() + table.size);
 }
 
 int ScaleMapper::mapNote(int incomingMidiNote) const {
-    if (scaleSemitones_.empty()) throw std::runtime_error("Scale not initialized");
-    return quantizeToScale(incomingMidiNote);
-}
-
-void ScaleMapper::buildLookupTable() const {
-    // Build lookup table for all 128 MIDI notes
-    lookupTable_.resize(128);
-    for (int i = 0; i < 128; ++i) {
-        lookupTable_[i] = quantizeToScale(i);
-    }
-    lookupTableValid_ = true;
+    return mapNoteFast(incomingMidiNote);
 }
 
 int ScaleMapper::mapNoteFast(int incomingMidiNote) const {
@@ -134,13 +51,111 @@ int ScaleMapper::mapNoteFast(int incomingMidiNote) const {
     if (incomingMidiNote < 0) incomingMidiNote = 0;
     if (incomingMidiNote > 127) incomingMidiNote = 127;
     
-    // Rebuild lookup table if settings have changed
-    if (!lookupTableValid_) {
-        buildLookupTable();
-    }
-    
     // O(1) lookup
-    return lookupTable_[incomingMidiNote];
+    return getScaleTable().noteMap[incomingMidiNote];
+}
+
+#if SCALECHORD_X86_DISPATCH
+namespace {
+
+// 128-entry byte lookup via pshufb: the table is split into eight 16-byte rows,
+// the low nibble indexes within a row and the high nibble selects the row.
+// Compiled for SSSE3/AVX2 whatever the build flags; only called when the CPU
+// has them.
+__attribute__((target("ssse3")))
+std::size_t mapNotesSsse3(const uint8_t* map, const uint8_t* in, uint8_t* out, std::size_t count) noexcept {
+    __m128i rows[8];
+    for (int row = 0; row < 8; ++row) {
+        rows[row] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(map + row * 16));
+    }
+    const __m128i lowMask = _mm_set1_epi8(0x0F);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i notes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        notes = _mm_min_epu8(notes, _mm_set1_epi8(127));
+        __m128i lo = _mm_and_si128(notes, lowMask);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(notes, 4), lowMask);
+        __m128i result = _mm_setzero_si128();
+        for (int row = 0; row < 8; ++row) {
+            __m128i hit = _mm_cmpeq_epi8(hi, _mm_set1_epi8(static_cast<char>(row)));
+            result = _mm_or_si128(result, _mm_and_si128(hit, _mm_shuffle_epi8(rows[row], lo)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+std::size_t mapNotesAvx2(const uint8_t* map, const uint8_t* in, uint8_t* out, std::size_t count) noexcept {
+    __m256i rows[8];
+    for (int row = 0; row < 8; ++row) {
+        rows[row] = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(map + row * 16)));
+    }
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+    std::size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i notes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        notes = _mm256_min_epu8(notes, _mm256_set1_epi8(127));
+        __m256i lo = _mm256_and_si256(notes, lowMask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(notes, 4), lowMask);
+        __m256i result = _mm256_setzero_si256();
+        for (int row = 0; row < 8; ++row) {
+            __m256i hit = _mm256_cmpeq_epi8(hi, _mm256_set1_epi8(static_cast<char>(row)));
+            result = _mm256_or_si256(result, _mm256_and_si256(hit, _mm256_shuffle_epi8(rows[row], lo)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+    }
+    // 16-byte remainder
+    return i + mapNotesSsse3(map, in + i, out + i, count - i);
+}
+
+} // namespace
+#endif
+
+ScaleMapper::SimdPath ScaleMapper::bestSimdPath() noexcept {
+#if SCALECHORD_X86_DISPATCH
+    static const SimdPath best = __builtin_cpu_supports("avx2")  ? SimdPath::AVX2
+                               : __builtin_cpu_supports("ssse3") ? SimdPath::SSSE3
+                                                                 : SimdPath::Scalar;
+    return best;
+#else
+    return SimdPath::Scalar;
+#endif
+}
+
+void ScaleMapper::mapNotes(const uint8_t* in, uint8_t* out, std::size_t count) const noexcept {
+    mapNotes(in, out, count, bestSimdPath());
+}
+
+void ScaleMapper::mapNotes(const uint8_t* in, uint8_t* out, std::size_t count, SimdPath path) const noexcept {
+    // One table snapshot for the whole block
+    const uint8_t* map = getScaleTable().noteMap.data();
+    std::size_t i = 0;
+
+#if SCALECHORD_X86_DISPATCH
+    path = std::min(path, bestSimdPath());
+    if (path == SimdPath::AVX2) i = mapNotesAvx2(map, in, out, count);
+    else if (path == SimdPath::SSSE3) i = mapNotesSsse3(map, in, out, count);
+#else
+    (void)path;
+#endif
+
+    // Scalar fallback / tail
+    for (; i < count; ++i) {
+        uint8_t note = in[i];
+        out[i] = map[note > 127 ? 127 : note];
+    }
+}
+
+void ScaleMapper::mapNotes(const int* in, int* out, std::size_t count) const noexcept {
+    const uint8_t* map = getScaleTable().noteMap.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        int note = in[i];
+        if (note < 0) note = 0;
+        if (note > 127) note = 127;
+        out[i] = map[note];
+    }
 }
 
 std::string ScaleMapper::scaleName(ScaleType t) {
@@ -182,12 +197,7 @@ std::string ScaleMapper::scaleName(ScaleType t) {
 
 int ScaleMapper::getScaleDegree(int semitoneInOctave) const {
     semitoneInOctave = ((semitoneInOctave % 12) + 12) % 12;
-    for (size_t i = 0; i < scaleSemitones_.size(); ++i) {
-        if (scaleSemitones_[i] == semitoneInOctave) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;  // Not in scale
+    return getScaleTable().degreeOf[semitoneInOctave];  // -1 if not in scale
 }
 
 std::vector<int> ScaleMapper::getChordIntervalsForDegree(int degree, int chordQuality) const {
@@ -195,14 +205,15 @@ std::vector<int> ScaleMapper::getChordIntervalsForDegree(int degree, int chordQu
     // chordQuality: 0=triad, 1=7th, 2=9th, etc.
     std::vector<int> intervals;
     int numDegrees = 2 + chordQuality * 2;  // 2, 4, 6, ...
+    const ScaleTable& table = getScaleTable();
     
     for (int i = 0; i < numDegrees; ++i) {
-        int idx = (degree + i * 2) % scaleSemitones_.size();
+        int idx = (degree + i * 2) % table.size;
         if (i == 0) {
-            intervals.push_back(scaleSemitones_[idx]);
+            intervals.push_back(table.semitones[idx]);
         } else {
             int prev = intervals.back();
-            int curr = scaleSemitones_[idx];
+            int curr = table.semitones[idx];
             // Handle wrap-around
             if (curr <= prev) curr += 12;
             intervals.push_back(curr);
@@ -212,42 +223,19 @@ std::vector<int> ScaleMapper::getChordIntervalsForDegree(int degree, int chordQu
 }
 
 ScaleType ScaleMapper::detectScale(const std::vector<int>& pitchClasses, int& outRootNote) {
-    // Simple scale detection based on pitch class distribution
-    if (pitchClasses.empty()) {
-        outRootNote = 0;
-        return ScaleType::Ionian;
+    // Out-of-range entries are ignored, duplicates count once
+    PitchClassSet set;
+    for (int pc : pitchClasses) {
+        if (pc >= 0 && pc < 12) set.insert(pc);
     }
-    
-    // Try each pitch class as root and each scale type
-    int bestMatch = 0;
-    int bestScore = 0;
-    int bestRoot = 0;
-    ScaleType bestScale = ScaleType::Ionian;
-    
-    for (int root = 0; root < 12; ++root) {
-        for (int scaleIdx = 0; scaleIdx <= static_cast<int>(ScaleType::Diminished); ++scaleIdx) {
-            auto scale = semitones_for_scale(static_cast<ScaleType>(scaleIdx));
-            int score = 0;
-            
-            for (int pc : pitchClasses) {
-                for (int degree : scale) {
-                    if ((root + degree) % 12 == pc) {
-                        score++;
-                        break;
-                    }
-                }
-            }
-            
-            if (score > bestScore) {
-                bestScore = score;
-                bestRoot = root;
-                bestScale = static_cast<ScaleType>(scaleIdx);
-            }
-        }
-    }
-    
-    outRootNote = bestRoot;
-    return bestScale;
+    return detectScale(set, outRootNote);
+}
+
+ScaleType ScaleMapper::detectScale(PitchClassSet pitchClasses, int& outRootNote) {
+    // Scale/root covering the most pitch classes (empty set gives C Ionian)
+    const ScaleTable& table = bestScaleTable(pitchClasses);
+    outRootNote = table.rootNote;
+    return table.scale;
 }
 
 } // namespace scalechord
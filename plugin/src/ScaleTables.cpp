@@ -0,0 +1,159 @@
+// Compile-time scale table generation
+#include "ScaleTables.h"
+
+namespace scalechord {
+
+namespace {
+
+constexpr std::array<ScaleIntervals, NUM_SCALE_TYPES> SCALE_INTERVALS = {{
+    // Major scale modes (Ionian mode = Major)
+    {{0,2,4,5,7,9,11,0}, 7},   // Ionian
+    {{0,2,3,5,7,9,10,0}, 7},   // Dorian
+    {{0,1,3,5,7,8,10,0}, 7},   // Phrygian
+    {{0,2,4,6,7,9,11,0}, 7},   // Lydian
+    {{0,2,4,5,7,9,10,0}, 7},   // Mixolydian
+    {{0,2,3,5,7,8,10,0}, 7},   // Aeolian (natural minor)
+    {{0,1,3,5,6,8,10,0}, 7},   // Locrian
+
+    // Minor scale variants
+    {{0,2,3,5,7,8,11,0}, 7},   // Harmonic minor (raised 7th)
+    {{0,2,3,5,7,9,11,0}, 7},   // Melodic minor (raised 6th & 7th)
+
+    // Pentatonic
+    {{0,2,4,7,9,0,0,0}, 5},    // Major pentatonic
+    {{0,3,5,7,10,0,0,0}, 5},   // Minor pentatonic
+
+    // Blues
+    {{0,2,3,4,7,9,0,0}, 6},    // Major blues (major pentatonic + b3)
+    {{0,3,5,6,7,10,0,0}, 6},   // Minor blues (minor pentatonic + b5)
+
+    // Other scales
+    {{0,2,4,6,8,10,0,0}, 6},   // Whole tone
+    {{0,2,3,5,6,8,9,11}, 8},   // Whole-half diminished
+}};
+
+constexpr int absDiff(int a, int b) { return a > b ? a - b : b - a; }
+
+// Nearest scale note to midiNote, searching one octave either side.
+// Ties resolve to the lower candidate.
+constexpr int nearestInScale(const ScaleTable& t, int midiNote) {
+    int octave = midiNote / 12;
+    int bestNote = octave * 12 + t.semitones[0];
+    int bestDist = 1000;
+    for (int o = -1; o <= 1; ++o) {
+        for (int i = 0; i < t.size; ++i) {
+            int candidate = (octave + o) * 12 + t.semitones[i];
+            if (candidate < 0 || candidate > 127) continue;
+            int dist = absDiff(candidate, midiNote);
+            if (dist < bestDist) {
+                bestDist = dist;
+                bestNote = candidate;
+            }
+        }
+    }
+    return bestNote;
+}
+
+constexpr ScaleTable makeScaleTable(ScaleType scale, const ScaleIntervals& intervals, int root) {
+    ScaleTable t{};
+    t.size = intervals.size;
+    t.scale = scale;
+    t.rootNote = static_cast<uint8_t>(root);
+
+    // Apply root, then insertion-sort the pitch classes ascending
+    for (int i = 0; i < t.size; ++i) {
+        int v = (root + intervals.semitones[i]) % 12;
+        int j = i;
+        while (j > 0 && t.semitones[j - 1] > v) {
+            t.semitones[j] = t.semitones[j - 1];
+            --j;
+        }
+        t.semitones[j] = static_cast<uint8_t>(v);
+    }
+
+    for (int pc = 0; pc < 12; ++pc) t.degreeOf[pc] = -1;
+    for (int i = 0; i < t.size; ++i) {
+        t.degreeOf[t.semitones[i]] = static_cast<int8_t>(i);
+        t.pitchClasses.insert(t.semitones[i]);
+    }
+
+    // Away from the MIDI range edges the search is the same in every octave,
+    // so solve it once per pitch class (keeps compile-time evaluation cheap)
+    int offsetOf[12] = {};
+    for (int pc = 0; pc < 12; ++pc) offsetOf[pc] = nearestInScale(t, 60 + pc) - (60 + pc);
+
+    for (int note = 0; note < 128; ++note) {
+        bool nearEdge = note < 12 || note >= 120;
+        t.noteMap[note] = static_cast<uint8_t>(nearEdge ? nearestInScale(t, note)
+                                                        : note + offsetOf[note % 12]);
+    }
+    return t;
+}
+
+constexpr std::array<ScaleTable, NUM_SCALE_TYPES * 12> makeAllScaleTables() {
+    std::array<ScaleTable, NUM_SCALE_TYPES * 12> tables{};
+    for (int s = 0; s < NUM_SCALE_TYPES; ++s) {
+        for (int root = 0; root < 12; ++root) {
+            tables[s * 12 + root] = makeScaleTable(static_cast<ScaleType>(s), SCALE_INTERVALS[s], root);
+        }
+    }
+    return tables;
+}
+
+constexpr std::array<ScaleTable, NUM_SCALE_TYPES * 12> SCALE_TABLES = makeAllScaleTables();
+
+// Spot-check the generator at compile time
+static_assert(SCALE_TABLES[0].noteMap[61] == 60, "C major: C# should map down to C");
+static_assert(SCALE_TABLES[0].degreeOf[11] == 6, "C major: B is the 7th degree");
+static_assert(SCALE_TABLES[2].semitones[0] == 1, "D major: lowest pitch class is C#");
+static_assert(SCALE_TABLES[0].pitchClasses.mask() == 0xAB5, "C major: pitch-class mask");
+
+// First scale/root covering the most pitch classes of set
+int bestScaleIndex(PitchClassSet set) noexcept {
+    int bestScore = 0;
+    int bestIndex = 0;
+    for (int root = 0; root < 12; ++root) {
+        for (int s = 0; s < NUM_SCALE_TYPES; ++s) {
+            int index = s * 12 + root;
+            int score = (set & SCALE_TABLES[index].pitchClasses).size();
+            if (score > bestScore) {
+                bestScore = score;
+                bestIndex = index;
+            }
+        }
+    }
+    return bestIndex;
+}
+
+// bestScaleIndex() for every possible set. Too many steps for a portable
+// constexpr evaluation, so it is filled during static initialization rather
+// than on the first (possibly audio-thread) detectScale() call.
+const std::array<uint8_t, 4096> BEST_SCALE = [] {
+    std::array<uint8_t, 4096> best{};
+    for (int mask = 0; mask < 4096; ++mask) {
+        best[mask] = static_cast<uint8_t>(bestScaleIndex(PitchClassSet(static_cast<uint16_t>(mask))));
+    }
+    return best;
+}();
+
+inline int scaleIndex(ScaleType t) noexcept {
+    int idx = static_cast<int>(t);
+    return (idx >= 0 && idx < NUM_SCALE_TYPES) ? idx : 0;  // Default to Ionian/Major
+}
+
+} // namespace
+
+const ScaleIntervals& scaleIntervals(ScaleType t) noexcept {
+    return SCALE_INTERVALS[scaleIndex(t)];
+}
+
+const ScaleTable& scaleTable(ScaleType t, int rootNote) noexcept {
+    int root = ((rootNote % 12) + 12) % 12;
+    return SCALE_TABLES[scaleIndex(t) * 12 + root];
+}
+
+const ScaleTable& bestScaleTable(PitchClassSet pitchClasses) noexcept {
+    return SCALE_TABLES[BEST_SCALE[pitchClasses.mask()]];
+}
+
+} // namespace scalechord
@@ -0,0 +1,193 @@
+#include "VoiceAllocator.h"
+#include <algorithm>
+
+namespace scalechord {
+
+namespace {
+
+inline int ctz64(uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1u)) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+inline int clz64(uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & (uint64_t(1) << 63))) { x <<= 1; ++n; }
+    return n;
+#endif
+}
+
+// Lowest/highest set bit of a 128-bit map (callers check it is non-empty)
+inline int lowestBit(const std::array<uint64_t, 2>& m) noexcept {
+    return m[0] ? ctz64(m[0]) : 64 + ctz64(m[1]);
+}
+
+inline int highestBit(const std::array<uint64_t, 2>& m) noexcept {
+    return m[1] ? 127 - clz64(m[1]) : 63 - clz64(m[0]);
+}
+
+inline void setBit(std::array<uint64_t, 2>& m, int i) noexcept { m[i >> 6] |= uint64_t(1) << (i & 63); }
+inline void clearBit(std::array<uint64_t, 2>& m, int i) noexcept { m[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+
+inline uint64_t budgetMask(int voices) noexcept {
+    return voices >= 64 ? ~uint64_t(0) : (uint64_t(1) << voices) - 1;
+}
+
+} // namespace
+
+VoiceAllocator::VoiceAllocator() {
+    reset();
+}
+
+VoiceAllocator::VoiceAllocator(const VoiceAllocatorSettings& s) {
+    setSettings(s);
+    reset();
+}
+
+void VoiceAllocator::setSettings(const VoiceAllocatorSettings& s) {
+    settings_ = s;
+    settings_.maxVoices = std::max(1, std::min(MAX_POLYPHONY, settings_.maxVoices));
+}
+
+VoiceAllocation VoiceAllocator::noteOn(int note, int velocity) noexcept {
+    VoiceAllocation result;
+    if (note < 0 || note > 127) return result;
+    velocity = std::max(1, std::min(127, velocity));
+
+    // Same pitch already sounding: retrigger it on its own voice
+    int voice = voiceForPitch_[note];
+    if (voice >= 0) {
+        release(voice);
+        assign(voice, note, velocity);
+        ++reuseCount_;
+        result.voice = voice;
+        result.stolenNote = note;
+        result.samePitchReuse = true;
+        return result;
+    }
+
+    uint64_t available = freeVoices_ & budgetMask(settings_.maxVoices);
+    if (activeCount_ < settings_.maxVoices && available) {
+        voice = ctz64(available);
+    } else {
+        voice = chooseVictim();
+        result.stolenNote = pitch_[voice];
+        release(voice);
+        ++stealCount_;
+    }
+
+    assign(voice, note, velocity);
+    result.voice = voice;
+    return result;
+}
+
+bool VoiceAllocator::noteOff(int note) noexcept {
+    if (note < 0 || note > 127 || voiceForPitch_[note] < 0) return false;
+    release(voiceForPitch_[note]);
+    return true;
+}
+
+bool VoiceAllocator::isSounding(int note) const noexcept {
+    return note >= 0 && note < 128 && voiceForPitch_[note] >= 0;
+}
+
+int VoiceAllocator::getVoiceNote(int voice) const noexcept {
+    return (voice >= 0 && voice < MAX_POLYPHONY) ? pitch_[voice] : -1;
+}
+
+void VoiceAllocator::getVoiceStates(bool* out, int count) const noexcept {
+    for (int i = 0; i < count; ++i) {
+        out[i] = i < MAX_POLYPHONY && pitch_[i] >= 0;
+    }
+}
+
+void VoiceAllocator::reset() noexcept {
+    pitch_.fill(-1);
+    velocity_.fill(0);
+    olderVoice_.fill(-1);
+    newerVoice_.fill(-1);
+    nextSameVelocity_.fill(-1);
+    prevSameVelocity_.fill(-1);
+    freeVoices_ = ~uint64_t(0);
+    voiceForPitch_.fill(-1);
+    velocityHead_.fill(-1);
+    velocityTail_.fill(-1);
+    soundingPitches_ = {};
+    usedVelocities_ = {};
+    oldest_ = newest_ = -1;
+    activeCount_ = 0;
+}
+
+int VoiceAllocator::chooseVictim() const noexcept {
+    switch (settings_.policy) {
+        case StealPolicy::Quietest:
+            return velocityHead_[lowestBit(usedVelocities_)];
+        case StealPolicy::Highest:
+            return voiceForPitch_[highestBit(soundingPitches_)];
+        case StealPolicy::Lowest:
+            return voiceForPitch_[lowestBit(soundingPitches_)];
+        case StealPolicy::Oldest:
+        default:
+            return oldest_;
+    }
+}
+
+void VoiceAllocator::assign(int voice, int note, int velocity) noexcept {
+    const int8_t v = static_cast<int8_t>(voice);
+    pitch_[voice] = static_cast<int8_t>(note);
+    velocity_[voice] = static_cast<uint8_t>(velocity);
+    freeVoices_ &= ~(uint64_t(1) << voice);
+    voiceForPitch_[note] = v;
+    setBit(soundingPitches_, note);
+
+    // Newest in the age list
+    olderVoice_[voice] = newest_;
+    newerVoice_[voice] = -1;
+    if (newest_ >= 0) newerVoice_[newest_] = v;
+    else oldest_ = v;
+    newest_ = v;
+
+    // Newest at its velocity
+    prevSameVelocity_[voice] = velocityTail_[velocity];
+    nextSameVelocity_[voice] = -1;
+    if (velocityTail_[velocity] >= 0) nextSameVelocity_[velocityTail_[velocity]] = v;
+    else velocityHead_[velocity] = v;
+    velocityTail_[velocity] = v;
+    setBit(usedVelocities_, velocity);
+
+    ++activeCount_;
+}
+
+void VoiceAllocator::release(int voice) noexcept {
+    int note = pitch_[voice];
+    int velocity = velocity_[voice];
+
+    if (olderVoice_[voice] >= 0) newerVoice_[olderVoice_[voice]] = newerVoice_[voice];
+    else oldest_ = newerVoice_[voice];
+    if (newerVoice_[voice] >= 0) olderVoice_[newerVoice_[voice]] = olderVoice_[voice];
+    else newest_ = olderVoice_[voice];
+
+    if (prevSameVelocity_[voice] >= 0) nextSameVelocity_[prevSameVelocity_[voice]] = nextSameVelocity_[voice];
+    else velocityHead_[velocity] = nextSameVelocity_[voice];
+    if (nextSameVelocity_[voice] >= 0) prevSameVelocity_[nextSameVelocity_[voice]] = prevSameVelocity_[voice];
+    else velocityTail_[velocity] = prevSameVelocity_[voice];
+    if (velocityHead_[velocity] < 0) clearBit(usedVelocities_, velocity);
+
+    voiceForPitch_[note] = -1;
+    clearBit(soundingPitches_, note);
+    pitch_[voice] = -1;
+    olderVoice_[voice] = newerVoice_[voice] = -1;
+    nextSameVelocity_[voice] = prevSameVelocity_[voice] = -1;
+    freeVoices_ |= uint64_t(1) << voice;
+    --activeCount_;
+}
+
+} // namespace scalechord
@@ -2,6 +2,10 @@
 #include <algorithm>
 #include <cmath>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 VoiceLeading::VoiceLeading() = default;
 
 int VoiceLeading::getPitchClass(int midiNote)
@@ -58,19 +62,75 @@ int VoiceLeading::findBestOctave(
     return bestNote;
 }
 
-std::vector<int> VoiceLeading::getPitchClassSet(const std::vector<int>& chord)
+scalechord::PitchClassSet VoiceLeading::getPitchClassSet(const std::vector<int>& chord)
 {
-    std::vector<int> pitchClasses;
-    for (int note : chord) {
-        pitchClasses.push_back(getPitchClass(note));
-    }
+    return scalechord::PitchClassSet::fromNotes(chord);
+}
+
+int VoiceLeading::placeNear(int sourceNote, int pitchClass, int octaveRange)
+{
+    const int sameOctave = sourceNote - getPitchClass(sourceNote) + getPitchClass(pitchClass);
+
+    int best = -1;
+    int bestDistance = 1000;
+    auto consider = [&](int note) {
+        if (note < 0 || note > 127) return;
+        int distance = std::abs(note - sourceNote);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = note;
+        }
+    };
 
-    std::sort(pitchClasses.begin(), pitchClasses.end());
-    pitchClasses.erase(
-        std::unique(pitchClasses.begin(), pitchClasses.end()),
-        pitchClasses.end());
+    consider(sameOctave);
+    if (octaveRange > 0 || sameOctave > 127) consider(sameOctave - 12);
+    if (octaveRange > 0 || sameOctave < 0) consider(sameOctave + 12);
+    return best;
+}
 
-    return pitchClasses;
+void VoiceLeading::computeCostRows(
+    const int* currentChord, int numCurrent,
+    const int16_t* pitchClasses, int octaveRange,
+    int16_t (*cost)[MAX_EXACT_VOICES])
+{
+#if defined(__SSE2__)
+    // Mirrors placeNear: distance to the same-octave candidate and the ones
+    // an octave down/up, out-of-range candidates masked to INF, then min
+    const __m128i pcs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pitchClasses));
+    const __m128i octave = _mm_set1_epi16(12);
+    const __m128i maxNote = _mm_set1_epi16(127);
+    const __m128i minusOne = _mm_set1_epi16(-1);
+    const __m128i inf = _mm_set1_epi16(INT16_MAX);
+    const __m128i allowOctaves = octaveRange > 0 ? _mm_set1_epi16(-1) : _mm_setzero_si128();
+
+    auto distance = [&](__m128i note, __m128i source, __m128i allowed) {
+        const __m128i diff = _mm_sub_epi16(note, source);
+        const __m128i dist = _mm_max_epi16(diff, _mm_sub_epi16(_mm_setzero_si128(), diff));
+        const __m128i inRange = _mm_andnot_si128(
+            _mm_or_si128(_mm_cmpgt_epi16(minusOne, note), _mm_cmpgt_epi16(note, maxNote)), allowed);
+        return _mm_or_si128(_mm_and_si128(inRange, dist), _mm_andnot_si128(inRange, inf));
+    };
+
+    for (int i = 0; i < numCurrent; ++i) {
+        const int note = currentChord[i];
+        const __m128i source = _mm_set1_epi16(static_cast<int16_t>(note));
+        const __m128i same = _mm_add_epi16(_mm_set1_epi16(static_cast<int16_t>(note - getPitchClass(note))), pcs);
+        const __m128i down = _mm_sub_epi16(same, octave);
+        const __m128i up = _mm_add_epi16(same, octave);
+
+        __m128i best = distance(same, source, _mm_set1_epi16(-1));
+        best = _mm_min_epi16(best, distance(down, source, _mm_or_si128(allowOctaves, _mm_cmpgt_epi16(same, maxNote))));
+        best = _mm_min_epi16(best, distance(up, source, _mm_or_si128(allowOctaves, _mm_cmpgt_epi16(_mm_setzero_si128(), same))));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cost[i]), best);
+    }
+#else
+    for (int i = 0; i < numCurrent; ++i) {
+        for (int j = 0; j < MAX_EXACT_VOICES; ++j) {
+            cost[i][j] = static_cast<int16_t>(
+                std::abs(placeNear(currentChord[i], pitchClasses[j], octaveRange) - currentChord[i]));
+        }
+    }
+#endif
 }
 
 std::vector<int> VoiceLeading::optimizeVoicing(
@@ -80,50 +140,139 @@ std::vector<int> VoiceLeading::optimizeVoicing(
 {
     if (targetChord.empty()) return targetChord;
 
-    std::vector<int> result;
-
-    // Get pitch classes
-    auto currentPitches = getPitchClassSet(currentChord);
-    auto targetPitches = getPitchClassSet(targetChord);
-
-    // Start with lowest note in target chord as reference
-    int baseNote = targetChord[0];
-    int baseOctave = getOctave(baseNote);
-
-    // Try to retain common tones in same position
-    std::vector<bool> used(currentChord.size(), false);
+    std::vector<int> result(targetChord.size());
+    int count = optimizeVoicing(currentChord.data(), static_cast<int>(currentChord.size()),
+                                targetChord.data(), static_cast<int>(targetChord.size()),
+                                result.data(), octaveRange);
+    result.resize(count);
+    return result;
+}
 
-    for (int targetPitch : targetPitches) {
-        int bestCurrentNote = -1;
-        int bestDistance = 1000;
+int VoiceLeading::optimizeVoicing(
+    const int* currentChord, int numCurrent,
+    const int* targetChord, int numTarget,
+    int* out, int octaveRange) const
+{
+    if (numTarget <= 0) return 0;
+
+    scalechord::PitchClassSet targetPitches;
+    for (int i = 0; i < numTarget; ++i) targetPitches.insert(targetChord[i]);
+    const int numPitches = targetPitches.size();
+
+    // Nothing to lead from: keep the target's lowest octave
+    if (numCurrent <= 0) {
+        int baseOctave = getOctave(targetChord[0]);
+        int count = 0;
+        for (int pitch : targetPitches) out[count++] = makeMidiNote(pitch, baseOctave);
+        std::sort(out, out + count);
+        return count;
+    }
 
-        // Look for common tone in current chord
-        for (int i = 0; i < static_cast<int>(currentChord.size()); ++i) {
-            if (used[i]) continue;
-            if (getPitchClass(currentChord[i]) == targetPitch) {
-                int distance = 0;  // Common tone = no movement
-                if (distance < bestDistance) {
-                    bestDistance = distance;
-                    bestCurrentNote = currentChord[i];
+    if (numCurrent > MAX_EXACT_VOICES || numPitches > MAX_EXACT_VOICES) {
+        // Too large for the exact solver: each pitch class near its closest voice
+        int count = 0;
+        for (int pitch : targetPitches) {
+            int best = placeNear(currentChord[0], pitch, octaveRange);
+            int bestDistance = std::abs(best - currentChord[0]);
+            for (int i = 1; i < numCurrent; ++i) {
+                int note = placeNear(currentChord[i], pitch, octaveRange);
+                if (std::abs(note - currentChord[i]) < bestDistance) {
+                    bestDistance = std::abs(note - currentChord[i]);
+                    best = note;
                 }
             }
+            out[count++] = best;
         }
+        std::sort(out, out + count);
+        return count;
+    }
 
-        // If no common tone, find best octave
-        if (bestCurrentNote == -1) {
-            bestCurrentNote = currentChord.empty() ?
-                makeMidiNote(targetPitch, baseOctave) : currentChord.back();
+    // Square problem of size n: rows are current voices, columns target pitch
+    // classes. Padding rows (more pitch classes than voices) cost the distance
+    // from the nearest voice; padding columns (voices that drop out) cost 0.
+    const int n = std::max(numCurrent, numPitches);
+    alignas(16) int16_t pitchClasses[MAX_EXACT_VOICES] = {};
+    int count = 0;
+    for (int pitch : targetPitches) pitchClasses[count++] = static_cast<int16_t>(pitch);
+
+    alignas(16) int16_t cost[MAX_EXACT_VOICES][MAX_EXACT_VOICES];
+    computeCostRows(currentChord, numCurrent, pitchClasses, octaveRange, cost);
+
+    int splitSource[MAX_EXACT_VOICES] = {};
+    for (int j = 0; j < numPitches; ++j) {
+        for (int i = 1; i < numCurrent; ++i) {
+            if (cost[i][j] < cost[splitSource[j]][j]) splitSource[j] = i;
         }
+    }
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            if (j >= numPitches) cost[i][j] = 0;
+            else if (i >= numCurrent) cost[i][j] = cost[splitSource[j]][j];
+        }
+    }
 
-        // Find best octave of target pitch
-        int optimizedNote = findBestOctave(bestCurrentNote, targetPitch, octaveRange);
-        result.push_back(optimizedNote);
+    // best[mask]: cheapest assignment of the first popcount(mask) rows to the
+    // columns in mask; lastColumn[mask] is the column taken by the last row
+    constexpr int STATES = 1 << MAX_EXACT_VOICES;
+    int32_t best[STATES];
+    int8_t lastColumn[STATES];
+    const int full = (1 << n) - 1;
+    best[0] = 0;
+    for (int mask = 1; mask <= full; ++mask) {
+        const int row = scalechord::PitchClassSet(static_cast<uint16_t>(mask)).size() - 1;
+        int32_t bestCost = INT32_MAX;
+        int8_t bestColumn = 0;
+        for (int m = mask; m; m &= m - 1) {
+            const int column = scalechord::PitchClassSet(static_cast<uint16_t>(m)).lowest();
+            const int32_t c = best[mask ^ (1 << column)] + cost[row][column];
+            if (c < bestCost) {
+                bestCost = c;
+                bestColumn = static_cast<int8_t>(column);
+            }
+        }
+        best[mask] = bestCost;
+        lastColumn[mask] = bestColumn;
     }
 
-    // Sort result in ascending order
-    std::sort(result.begin(), result.end());
+    count = 0;
+    for (int mask = full, row = n - 1; row >= 0; --row) {
+        const int column = lastColumn[mask];
+        mask ^= 1 << column;
+        if (column >= numPitches) continue;  // voice dropped out
+        const int source = currentChord[row < numCurrent ? row : splitSource[column]];
+        out[count++] = placeNear(source, pitchClasses[column], octaveRange);
+    }
+    std::sort(out, out + count);
+    return count;
+}
 
-    return result;
+float VoiceLeading::smoothness(int totalDistance, int voices, int commonTones, int parallels)
+{
+    // Penalize distance proportionally to chord size
+    float avgDistance = totalDistance / static_cast<float>(voices);
+    float distancePenalty = std::min(avgDistance * 2.0f, 80.0f);
+    float commonToneBonus = commonTones * 8.0f;
+    float parallelPenalty = parallels * PARALLEL_PENALTY;
+
+    float score = 100.0f - distancePenalty + commonToneBonus - parallelPenalty;
+    return std::max(0.0f, std::min(100.0f, score));
+}
+
+int VoiceLeading::countParallels(const int* from, const int* to, int voices)
+{
+    int count = 0;
+    for (int i = 0; i < voices; ++i) {
+        int moveI = to[i] - from[i];
+        if (moveI == 0) continue;
+        for (int j = i + 1; j < voices; ++j) {
+            int before = getPitchClass(from[j] - from[i]);
+            if (before != 0 && before != 7) continue;
+            int moveJ = to[j] - from[j];
+            bool sameDirection = (moveI > 0 && moveJ > 0) || (moveI < 0 && moveJ < 0);
+            if (sameDirection && getPitchClass(to[j] - to[i]) == before) ++count;
+        }
+    }
+    return count;
 }
 
 float VoiceLeading::scoreVoiceLeading(
@@ -148,21 +297,143 @@ float VoiceLeading::scoreVoiceLeading(
     auto fromPitches = getPitchClassSet(from);
     auto toPitches = getPitchClassSet(to);
 
-    int commonTones = 0;
-    for (int pitch : fromPitches) {
-        if (std::find(toPitches.begin(), toPitches.end(), pitch) != toPitches.end()) {
-            commonTones++;
+    int commonTones = (fromPitches & toPitches).size();
+
+    int voices = static_cast<int>(std::min(from.size(), to.size()));
+    int parallels = countParallels(from.data(), to.data(), voices);
+
+    return smoothness(totalDistance, maxDistance, commonTones, parallels);
+}
+
+void VoiceLeading::scoreVoiceLeadingBatch(
+    const int* from, int numFrom,
+    const int8_t* candidates, int numCandidates,
+    float* outScores) const
+{
+    if (numCandidates <= 0) return;
+
+    if (numFrom <= 0 || numFrom > BATCH_WIDTH) {
+        std::vector<int> source(from, from + std::max(0, numFrom));
+        for (int c = 0; c < numCandidates; ++c) {
+            std::vector<int> candidate;
+            for (int v = 0; v < BATCH_WIDTH && candidates[c * BATCH_WIDTH + v] >= 0; ++v) {
+                candidate.push_back(candidates[c * BATCH_WIDTH + v]);
+            }
+            outScores[c] = scoreVoiceLeading(source, candidate);
         }
+        return;
     }
 
-    // Calculate smoothness score
-    // Penalize distance proportionally to chord size
-    float avgDistance = totalDistance / static_cast<float>(maxDistance);
-    float distancePenalty = std::min(avgDistance * 2.0f, 80.0f);
-    float commonToneBonus = commonTones * 8.0f;
+    // Source padded with 60 (the scalar version's stand-in for a missing
+    // voice), then the voice pairs that are a unison/octave or fifth apart
+    int source[BATCH_WIDTH];
+    for (int v = 0; v < BATCH_WIDTH; ++v) source[v] = v < numFrom ? from[v] : 60;
+    scalechord::PitchClassSet fromPitches;
+    for (int v = 0; v < numFrom; ++v) fromPitches.insert(from[v]);
+
+    int numPairs = 0;
+    int8_t pairLow[BATCH_WIDTH * (BATCH_WIDTH - 1) / 2];
+    int8_t pairHigh[BATCH_WIDTH * (BATCH_WIDTH - 1) / 2];
+    int8_t pairInterval[BATCH_WIDTH * (BATCH_WIDTH - 1) / 2];
+    for (int i = 0; i < numFrom; ++i) {
+        for (int j = i + 1; j < numFrom; ++j) {
+            int interval = getPitchClass(from[j] - from[i]);
+            if (interval != 0 && interval != 7) continue;
+            pairLow[numPairs] = static_cast<int8_t>(i);
+            pairHigh[numPairs] = static_cast<int8_t>(j);
+            pairInterval[numPairs] = static_cast<int8_t>(interval);
+            ++numPairs;
+        }
+    }
 
-    float score = 100.0f - distancePenalty + commonToneBonus;
-    return std::max(0.0f, std::min(100.0f, score));
+    int c = 0;
+#if defined(__SSE2__)
+    // Two candidates per register (one per 64-bit half)
+    alignas(16) int8_t sourceBytes[16];
+    for (int v = 0; v < 16; ++v) sourceBytes[v] = static_cast<int8_t>(std::max(0, std::min(127, source[v % BATCH_WIDTH])));
+    const __m128i fromBytes = _mm_load_si128(reinterpret_cast<const __m128i*>(sourceBytes));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i minusOne = _mm_set1_epi8(-1);
+    const __m128i twelve = _mm_set1_epi8(12);
+
+    for (; c + 2 <= numCandidates; c += 2) {
+        const __m128i notes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(candidates + c * BATCH_WIDTH));
+        const __m128i valid = _mm_cmpgt_epi8(notes, minusOne);
+        const int validMask = _mm_movemask_epi8(valid);
+        const int size[2] = {scalechord::PitchClassSet(static_cast<uint16_t>(validMask & 0xFF)).size(),
+                             scalechord::PitchClassSet(static_cast<uint16_t>(validMask >> 8)).size()};
+
+        // Distance: unused lanes read as 60, so lanes past both chords add 0
+        const __m128i padded = _mm_or_si128(_mm_and_si128(valid, notes), _mm_andnot_si128(valid, _mm_set1_epi8(60)));
+        const __m128i sad = _mm_sad_epu8(padded, fromBytes);
+        const int distance[2] = {_mm_cvtsi128_si32(sad), _mm_extract_epi16(sad, 4)};
+
+        // Pitch classes by conditional subtraction (unused lanes stay negative)
+        __m128i pitch = notes;
+        for (int step : {96, 48, 24, 12}) {
+            const __m128i ge = _mm_cmpgt_epi8(pitch, _mm_set1_epi8(static_cast<char>(step - 1)));
+            pitch = _mm_sub_epi8(pitch, _mm_and_si128(ge, _mm_set1_epi8(static_cast<char>(step))));
+        }
+
+        int common[2] = {0, 0};
+        for (int pc : fromPitches) {
+            const int hit = _mm_movemask_epi8(_mm_cmpeq_epi8(pitch, _mm_set1_epi8(static_cast<char>(pc))));
+            common[0] += (hit & 0xFF) != 0;
+            common[1] += (hit >> 8) != 0;
+        }
+
+        // Parallels: shifting each 64-bit half right by (j - i) bytes lines
+        // voice j up with voice i
+        int parallels[2] = {0, 0};
+        if (numPairs > 0) {
+            const __m128i motion = _mm_sub_epi8(notes, fromBytes);
+            const __m128i up = _mm_cmpgt_epi8(motion, zero);
+            const __m128i down = _mm_cmpgt_epi8(zero, motion);
+            for (int p = 0; p < numPairs; ++p) {
+                const __m128i shift = _mm_cvtsi32_si128(8 * (pairHigh[p] - pairLow[p]));
+                __m128i interval = _mm_sub_epi8(_mm_srl_epi64(pitch, shift), pitch);
+                interval = _mm_add_epi8(interval, _mm_and_si128(_mm_cmpgt_epi8(zero, interval), twelve));
+                const __m128i sameDirection = _mm_or_si128(_mm_and_si128(up, _mm_srl_epi64(up, shift)),
+                                                           _mm_and_si128(down, _mm_srl_epi64(down, shift)));
+                const __m128i hit = _mm_and_si128(_mm_and_si128(valid, _mm_srl_epi64(valid, shift)),
+                    _mm_and_si128(sameDirection, _mm_cmpeq_epi8(interval, _mm_set1_epi8(pairInterval[p]))));
+                const int mask = _mm_movemask_epi8(hit);
+                parallels[0] += (mask >> pairLow[p]) & 1;
+                parallels[1] += (mask >> (8 + pairLow[p])) & 1;
+            }
+        }
+
+        for (int k = 0; k < 2; ++k) {
+            outScores[c + k] = size[k] == 0 ? 50.0f
+                : smoothness(distance[k], std::max(numFrom, size[k]), common[k], parallels[k]);
+        }
+    }
+#endif
+
+    // Remaining candidates (or all of them without SSE2)
+    for (; c < numCandidates; ++c) {
+        const int8_t* row = candidates + c * BATCH_WIDTH;
+        int notes[BATCH_WIDTH];
+        int size = 0;
+        while (size < BATCH_WIDTH && row[size] >= 0) {
+            notes[size] = row[size];
+            ++size;
+        }
+        if (size == 0) {
+            outScores[c] = 50.0f;
+            continue;
+        }
+
+        int totalDistance = 0;
+        scalechord::PitchClassSet toPitches;
+        for (int v = 0; v < BATCH_WIDTH; ++v) {
+            totalDistance += std::abs((v < size ? notes[v] : 60) - source[v]);
+            if (v < size) toPitches.insert(notes[v]);
+        }
+        int parallels = countParallels(from, notes, std::min(numFrom, size));
+        outScores[c] = smoothness(totalDistance, std::max(numFrom, size),
+                                  (fromPitches & toPitches).size(), parallels);
+    }
 }
 
 VoiceLeadingResult VoiceLeading::suggestSmoothVoicing(
@@ -188,12 +459,7 @@ VoiceLeadingResult VoiceLeading::suggestSmoothVoicing(
     auto fromPitches = getPitchClassSet(currentChord);
     auto toPitches = getPitchClassSet(result.nextChord);
 
-    result.commonToneCount = 0;
-    for (int pitch : fromPitches) {
-        if (std::find(toPitches.begin(), toPitches.end(), pitch) != toPitches.end()) {
-            result.commonToneCount++;
-        }
-    }
+    result.commonToneCount = (fromPitches & toPitches).size();
 
     result.hasCommonTones = result.commonToneCount > 0;
 
@@ -7,8 +7,14 @@
 
 #include "ScaleMapper.h"
 #include "ChordVoicer.h"
+#include "ChordAnalyzer.h"
 #include "Envelope.h"
+#include "EnvelopeBank.h"
+#include "EventScheduler.h"
 #include "PerformanceMetrics.h"
+#include "ProgressionReharmonizer.h"
+#include "ProgressionVoicer.h"
+#include "VoiceLeading.h"
 
 using namespace scalechord;
 
@@ -109,6 +115,31 @@ void benchmark_scale_mapper() {
     // Calculate improvement
     double improvement = (original.avgTimeUs - optimized.avgTimeUs) / original.avgTimeUs * 100;
     printf("\n  Improvement: %.1f%% faster\n", improvement);
+
+    // Benchmark 3: Batch mapNotes() over a rendered-MIDI-sized block
+    printf("\n  Batch mapNotes() (16384 notes):\n");
+    std::vector<uint8_t> block(16384), mapped(16384);
+    for (size_t i = 0; i < block.size(); ++i) block[i] = static_cast<uint8_t>((i * 7) % 128);
+
+    SimpleBenchmark::Result perNote = SimpleBenchmark::measure(
+        "  mapNoteFast() loop - 16384 notes",
+        200,
+        [&]() {
+            for (size_t i = 0; i < block.size(); ++i) {
+                mapped[i] = static_cast<uint8_t>(mapper.mapNoteFast(block[i]));
+            }
+        }
+    );
+
+    SimpleBenchmark::Result batch = SimpleBenchmark::measure(
+        "  mapNotes() batch - 16384 notes",
+        200,
+        [&]() {
+            mapper.mapNotes(block.data(), mapped.data(), block.size());
+        }
+    );
+
+    printf("  Batch speedup: %.1fx\n", perNote.avgTimeUs / batch.avgTimeUs);
 }
 
 // ============================================================================
@@ -144,6 +175,79 @@ void benchmark_chord_voicer() {
     );
 
     printf("  Average per chord: %.3f μs\n", result.avgTimeUs / roots.size());
+
+    ChordBuffer chord;
+    SimpleBenchmark::Result fixed = SimpleBenchmark::measure(
+        "  makeChordInto() - 1000 calls",
+        1000,
+        [&]() {
+            for (int root : roots) {
+                voicer.makeChordInto(root, chord);
+            }
+        }
+    );
+
+    printf("  Average per chord (no allocation): %.3f μs\n", fixed.avgTimeUs / roots.size());
+}
+
+// ============================================================================
+// BENCHMARK: ChordVoicer cache
+// ============================================================================
+
+void benchmark_chord_cache() {
+    printf("\n=== Benchmark: ChordVoicer Cache ===\n");
+
+    MapperSettings ms;
+    ms.rootNote = 0;
+    ms.scale = ScaleType::Ionian;
+
+    ScaleMapper mapper(ms);
+
+    VoicerSettings vs;
+    vs.voicing = VoicingType::Seventh;
+    vs.octaveOffset = 0;
+
+    ChordVoicer voicer(mapper);
+    voicer.setSettings(vs);
+    voicer.buildChordCache();
+
+    ChordBuffer chord;
+    volatile int sink = 0;
+
+    // All 128 input notes per iteration
+    SimpleBenchmark::Result uncached = SimpleBenchmark::measure(
+        "  Uncached makeChordInto() - 128 notes",
+        1000,
+        [&]() {
+            for (int note = 0; note < 128; ++note) {
+                voicer.makeChordInto(note, chord);
+                sink = sink + chord[0];
+            }
+        }
+    );
+
+    SimpleBenchmark::Result cached = SimpleBenchmark::measure(
+        "  Cached getCachedChord() - 128 notes",
+        1000,
+        [&]() {
+            for (int note = 0; note < 128; ++note) {
+                sink = sink + voicer.getCachedChord(note)[0];
+            }
+        }
+    );
+
+    SimpleBenchmark::Result rebuild = SimpleBenchmark::measure(
+        "  buildChordCache() (settings change)",
+        1000,
+        [&]() {
+            voicer.buildChordCache();
+        }
+    );
+
+    printf("  Uncached: %.1f M chords/s\n", 128.0 / uncached.avgTimeUs);
+    printf("  Cached:   %.1f M chords/s\n", 128.0 / cached.avgTimeUs);
+    printf("  Speedup:  %.1fx (rebuild cost %.3f μs)\n",
+           uncached.avgTimeUs / cached.avgTimeUs, rebuild.avgTimeUs);
 }
 
 // ============================================================================
@@ -173,6 +277,109 @@ void benchmark_envelope() {
     printf("  Note: Envelope is already optimized (< 0.001 ms)\n");
 }
 
+void benchmark_envelope_bank() {
+    printf("\n=== Benchmark: EnvelopeBank vs 64 Envelopes (512-sample block) ===\n");
+
+    const int voices = EnvelopeBank::MAX_VOICES;
+    const int blockSize = 512;
+    EnvelopeSettings es;
+    es.attack = 10;
+    es.decay = 50;
+    es.sustain = 0.7f;
+    es.release = 100;
+
+    std::vector<Envelope> scalar(voices, Envelope(es));
+    EnvelopeBank bank(es);
+    bank.setSampleRate(44100.0f);
+    for (int v = 0; v < voices; ++v) {
+        scalar[v].noteOn(40 + v, 44100.0f);
+        bank.noteOn(v, 40 + v);
+    }
+
+    // Retrigger every 64 blocks so the attack/decay transitions stay in the mix
+    int block = 0;
+    volatile float sink = 0.0f;
+    SimpleBenchmark::Result scalarResult = SimpleBenchmark::measure(
+        "  64 x Envelope::process() per sample",
+        2000,
+        [&]() {
+            if (++block % 64 == 0) {
+                for (int v = 0; v < voices; ++v) scalar[v].noteOn(40 + v, 44100.0f);
+            }
+            float sum = 0.0f;
+            for (int v = 0; v < voices; ++v) {
+                for (int i = 0; i < blockSize; ++i) sum += scalar[v].process();
+            }
+            sink = sink + sum;
+        }
+    );
+
+    block = 0;
+    SimpleBenchmark::Result bankResult = SimpleBenchmark::measure(
+        "  EnvelopeBank::process() per block",
+        2000,
+        [&]() {
+            if (++block % 64 == 0) {
+                for (int v = 0; v < voices; ++v) bank.noteOn(v, 40 + v);
+            }
+            bank.process(blockSize);
+            sink = sink + bank.getLevels()[0];
+        }
+    );
+
+    printf("  Speedup: %.1fx\n", scalarResult.avgTimeUs / bankResult.avgTimeUs);
+}
+
+void benchmark_exponential_envelope() {
+    printf("\n=== Benchmark: ExponentialEnvelope vs Envelope (1 s per note) ===\n");
+
+    for (float sampleRate : {44100.0f, 192000.0f}) {
+        for (bool humanize : {false, true}) {
+            EnvelopeSettings es;
+            es.attack = 10;
+            es.decay = 50;
+            es.sustain = 0.7f;
+            es.release = 100;
+            es.humanize = humanize;
+
+            // Note held for half a second, then released
+            const int samples = static_cast<int>(sampleRate);
+            Envelope env(es);
+            ExponentialEnvelope expEnv(es);
+            volatile float sink = 0.0f;
+            char label[64];
+
+            std::snprintf(label, sizeof(label), "  Envelope %.1fk%s", sampleRate / 1000.0f,
+                          humanize ? " humanized" : "");
+            SimpleBenchmark::Result current = SimpleBenchmark::measure(label, 50, [&]() {
+                env.noteOn(100, sampleRate);
+                float sum = 0.0f;
+                for (int i = 0; i < samples; ++i) {
+                    if (i == samples / 2) env.noteOff();
+                    sum += env.process();
+                }
+                sink = sink + sum;
+            });
+
+            std::snprintf(label, sizeof(label), "  ExponentialEnvelope %.1fk%s", sampleRate / 1000.0f,
+                          humanize ? " humanized" : "");
+            SimpleBenchmark::Result recurrence = SimpleBenchmark::measure(label, 50, [&]() {
+                expEnv.noteOn(100, sampleRate);
+                float sum = 0.0f;
+                for (int i = 0; i < samples; ++i) {
+                    if (i == samples / 2) expEnv.noteOff();
+                    sum += expEnv.process();
+                }
+                sink = sink + sum;
+            });
+
+            printf("    %.0f vs %.0f Msamples/s (%.1fx)\n",
+                   samples / current.avgTimeUs, samples / recurrence.avgTimeUs,
+                   current.avgTimeUs / recurrence.avgTimeUs);
+        }
+    }
+}
+
 // ============================================================================
 // BENCHMARK: PerformanceMetrics
 // ============================================================================
@@ -309,6 +516,276 @@ void benchmark_comparison() {
            (original_result.avgTimeUs - optimized_result.avgTimeUs) / original_result.avgTimeUs * 100);
 }
 
+// ============================================================================
+// BENCHMARK: ChordAnalyzer
+// ============================================================================
+
+void benchmark_chord_analyzer() {
+    printf("\n=== Benchmark: ChordAnalyzer ===\n");
+
+    ChordAnalyzer analyzer;
+    std::vector<int> seventh{67, 71, 74, 77};       // G7, root position
+    std::vector<int> inverted{64, 67, 72, 74};      // C(add9)/E
+    volatile float sink = 0.0f;
+
+    SimpleBenchmark::measure(
+        "  analyzeChord() - G7",
+        10000,
+        [&]() {
+            sink = sink + analyzer.analyzeChord(seventh, 0).confidence;
+        }
+    );
+
+    SimpleBenchmark::measure(
+        "  analyzeChordAmbiguous() - inversion",
+        10000,
+        [&]() {
+            sink = sink + static_cast<float>(analyzer.analyzeChordAmbiguous(inverted, 0).size());
+        }
+    );
+
+    SimpleBenchmark::Result lookup = SimpleBenchmark::measure(
+        "  matchPitchClasses() - all 4096 sets",
+        1000,
+        [&]() {
+            for (int mask = 0; mask < 4096; ++mask) {
+                sink = sink + ChordAnalyzer::matchPitchClasses(PitchClassSet(static_cast<uint16_t>(mask))).confidence;
+            }
+        }
+    );
+
+    printf("  Table lookups: %.1f M sets/s\n", 4096.0 / lookup.avgTimeUs);
+}
+
+// ============================================================================
+// BENCHMARK: VoiceLeading
+// ============================================================================
+
+void benchmark_voice_leading() {
+    printf("\n=== Benchmark: VoiceLeading ===\n");
+
+    VoiceLeading voiceLeading;
+    const int g7[] = {55, 59, 62, 65};
+    const int c[] = {60, 64, 67, 71};
+    const int cluster[] = {48, 50, 53, 55, 57, 60, 62, 64};
+    const int wide[] = {37, 44, 46, 51, 54, 58, 61, 66};
+    int out[8];
+    volatile int sink = 0;
+
+    SimpleBenchmark::measure(
+        "  optimizeVoicing() - 4 voices",
+        10000,
+        [&]() {
+            sink = sink + voiceLeading.optimizeVoicing(g7, 4, c, 4, out, 2) + out[0];
+        }
+    );
+
+    SimpleBenchmark::Result worst = SimpleBenchmark::measure(
+        "  optimizeVoicing() - 8 voices (worst case)",
+        10000,
+        [&]() {
+            sink = sink + voiceLeading.optimizeVoicing(cluster, 8, wide, 8, out, 2) + out[0];
+        }
+    );
+
+    printf("  Worst case: %.3f μs/call (%.1f%% of a 32-sample block at 48 kHz)\n",
+           worst.avgTimeUs, worst.avgTimeUs / (32.0 / 48000.0 * 1e6) * 100.0);
+
+    // Scoring 32 candidate voicings of F against a C major source
+    const int source[] = {60, 64, 67, 72};
+    const int numCandidates = 32;
+    std::vector<std::vector<int>> candidates;
+    std::vector<int8_t> rows(numCandidates * VoiceLeading::BATCH_WIDTH, -1);
+    for (int c = 0; c < numCandidates; ++c) {
+        std::vector<int> voicing = {53 + (c % 4) * 12, 57 + (c % 3) * 12, 60 + (c % 2) * 12, 65 + (c / 8) * 3};
+        std::sort(voicing.begin(), voicing.end());
+        for (int v = 0; v < 4; ++v) rows[c * VoiceLeading::BATCH_WIDTH + v] = static_cast<int8_t>(voicing[v]);
+        candidates.push_back(voicing);
+    }
+    const std::vector<int> sourceChord(source, source + 4);
+    float scores[numCandidates];
+    volatile float scoreSink = 0.0f;
+
+    SimpleBenchmark::Result single = SimpleBenchmark::measure(
+        "  scoreVoiceLeading() x32",
+        10000,
+        [&]() {
+            for (const auto& candidate : candidates) scoreSink = scoreSink + voiceLeading.scoreVoiceLeading(sourceChord, candidate);
+        }
+    );
+
+    SimpleBenchmark::Result batch = SimpleBenchmark::measure(
+        "  scoreVoiceLeadingBatch() - 32 candidates",
+        10000,
+        [&]() {
+            voiceLeading.scoreVoiceLeadingBatch(source, 4, rows.data(), numCandidates, scores);
+            scoreSink = scoreSink + scores[numCandidates - 1];
+        }
+    );
+
+    printf("  Batch speedup: %.1fx (%.1f ns/candidate)\n",
+           single.avgTimeUs / batch.avgTimeUs, batch.avgTimeUs * 1000.0 / numCandidates);
+}
+
+// ============================================================================
+// BENCHMARK: ProgressionVoicer
+// ============================================================================
+
+void benchmark_progression_voicer() {
+    printf("\n=== Benchmark: ProgressionVoicer (500-chord tune) ===\n");
+
+    // Rhythm-changes-like loop of 4-note chords in varying keys
+    const std::vector<std::vector<int>> bars = {
+        {60, 64, 67, 71}, {57, 60, 64, 67}, {62, 65, 69, 72}, {55, 59, 62, 65},
+        {64, 67, 71, 74}, {57, 61, 64, 67}, {62, 65, 69, 72}, {55, 59, 62, 65},
+        {60, 64, 67, 70}, {65, 69, 72, 76}, {66, 69, 72, 75}, {60, 64, 67, 71},
+        {64, 68, 71, 74}, {69, 73, 76, 79}, {62, 66, 69, 72}, {67, 71, 74, 77}};
+    std::vector<std::vector<int>> tune;
+    for (int i = 0; i < 500; ++i) {
+        std::vector<int> chord = bars[i % bars.size()];
+        for (int& note : chord) note += (i / 64) % 5;  // modulate every 64 chords
+        tune.push_back(chord);
+    }
+
+    ProgressionVoicerSettings single;
+    single.segmentLength = 0;
+    ProgressionVoicer whole(single);
+
+    ProgressionVoicerSettings parallelSettings;
+    parallelSettings.segmentLength = 64;
+    ProgressionVoicer segmented(parallelSettings);
+
+    volatile float sink = 0.0f;
+    SimpleBenchmark::Result wholeResult = SimpleBenchmark::measure(
+        "  optimize() - one segment, 1 thread",
+        50,
+        [&]() {
+            sink = sink + whole.optimize(tune).totalCost;
+        }
+    );
+
+    SimpleBenchmark::Result parallelResult = SimpleBenchmark::measure(
+        "  optimize() - 64-chord segments, all cores",
+        50,
+        [&]() {
+            sink = sink + segmented.optimize(tune).totalCost;
+        }
+    );
+
+    printf("  500 chords: %.2f ms single, %.2f ms segmented\n",
+           wholeResult.avgTimeUs / 1000.0, parallelResult.avgTimeUs / 1000.0);
+    printf("  Written voicing cost %.0f -> optimized %.0f\n",
+           whole.scoreVoicings(tune), whole.optimize(tune).totalCost);
+}
+
+// ============================================================================
+// BENCHMARK: EventScheduler
+// ============================================================================
+
+void benchmark_reharmonizer() {
+    printf("\n=== Benchmark: ProgressionReharmonizer (512-chord tune) ===\n");
+
+    // ii-V-I-vi / iii-VI-ii-V loop in C, 16-chord sections
+    const std::vector<std::vector<int>> bars = {
+        {62, 65, 69, 72}, {55, 59, 62, 65}, {60, 64, 67, 71}, {57, 60, 64, 67},
+        {64, 67, 71, 74}, {57, 61, 64, 67}, {62, 65, 69, 72}, {55, 59, 62, 65}};
+    std::vector<TimelineChord> timeline;
+    for (int i = 0; i < 512; ++i) {
+        TimelineChord chord;
+        chord.ppq = 4.0 * i;
+        chord.notes = bars[i % bars.size()];
+        chord.sectionStart = i % 16 == 0;
+        timeline.push_back(chord);
+    }
+
+    ReharmonizerSettings single;
+    single.maxThreads = 1;
+    ProgressionReharmonizer sequential(single);
+    ProgressionReharmonizer parallel;
+
+    volatile float sink = 0.0f;
+    SimpleBenchmark::Result singleResult = SimpleBenchmark::measure(
+        "  reharmonize() - 1 thread",
+        50,
+        [&]() {
+            sink = sink + sequential.reharmonize(timeline).totalScore;
+        }
+    );
+
+    SimpleBenchmark::Result parallelResult = SimpleBenchmark::measure(
+        "  reharmonize() - sections on all cores",
+        50,
+        [&]() {
+            sink = sink + parallel.reharmonize(timeline).totalScore;
+        }
+    );
+
+    ProgressionReharmonizer live;
+    size_t next = 0;
+    int out[ProgressionReharmonizer::MAX_NOTES];
+    SimpleBenchmark::measure(
+        "  nextChord() - real-time extension",
+        100000,
+        [&]() {
+            const std::vector<int>& notes = bars[next++ % bars.size()];
+            sink = sink + live.nextChord(notes.data(), static_cast<int>(notes.size()), out);
+        }
+    );
+
+    printf("  512 chords: %.2f ms single, %.2f ms parallel\n",
+           singleResult.avgTimeUs / 1000.0, parallelResult.avgTimeUs / 1000.0);
+}
+
+void benchmark_event_scheduler() {
+    printf("\n=== Benchmark: EventScheduler (10k pending events) ===\n");
+
+    const int pendingEvents = 10000;
+    const int blockSize = 512;
+    EventScheduler scheduler(pendingEvents);
+    scheduler.prepare(44100.0, 120.0);
+
+    // Spread over ~10 s so all three wheel levels are populated
+    std::vector<int64_t> delays(pendingEvents);
+    uint32_t seed = 12345;
+    for (int64_t& d : delays) {
+        seed = seed * 1664525u + 1013904223u;
+        d = static_cast<int64_t>(seed % 441000u);
+    }
+
+    volatile int sink = 0;
+    SimpleBenchmark::Result insert = SimpleBenchmark::measure(
+        "  scheduleAfter() x10k",
+        100,
+        [&]() {
+            scheduler.clear();
+            for (int64_t d : delays) scheduler.scheduleAfter(d, 0x90, 60, 100);
+        }
+    );
+
+    // Drain everything block by block; each iteration refills the wheel first
+    int blocks = 0;
+    SimpleBenchmark::Result drain = SimpleBenchmark::measure(
+        "  processBlock() - drain 10k over 10 s",
+        20,
+        [&]() {
+            scheduler.clear();
+            for (int64_t d : delays) scheduler.scheduleAfter(d, 0x90, 60, 100);
+            blocks = 0;
+            while (scheduler.getPendingCount() > 0) {
+                scheduler.processBlock(blockSize, [&](const ScheduledMidiEvent& e, int offset) {
+                    sink = sink + e.data1 + offset;
+                });
+                ++blocks;
+            }
+        }
+    );
+
+    const double drainOnlyUs = drain.avgTimeUs - insert.avgTimeUs;
+    printf("  Insert: %.1f ns/event\n", insert.avgTimeUs * 1000.0 / pendingEvents);
+    printf("  Drain:  %.1f ns/event, %.3f μs/block over %d blocks\n",
+           drainOnlyUs * 1000.0 / pendingEvents, drainOnlyUs / blocks, blocks);
+}
+
 // ============================================================================
 // Main Benchmarking Suite
 // ============================================================================
@@ -322,7 +799,15 @@ int main() {
     try {
         benchmark_scale_mapper();
         benchmark_chord_voicer();
+        benchmark_chord_cache();
+        benchmark_chord_analyzer();
+        benchmark_voice_leading();
+        benchmark_progression_voicer();
+        benchmark_reharmonizer();
         benchmark_envelope();
+        benchmark_envelope_bank();
+        benchmark_exponential_envelope();
+        benchmark_event_scheduler();
         benchmark_performance_metrics();
         benchmark_full_pipeline();
         benchmark_comparison();
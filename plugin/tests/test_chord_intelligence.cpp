@@ -1,9 +1,16 @@
 #include <cassert>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <iterator>
 #include "../include/ChordAnalyzer.h"
 #include "../include/VoiceLeading.h"
+#include "../include/ProgressionVoicer.h"
 #include "../include/JazzReharmonizer.h"
+#include "../include/ProgressionReharmonizer.h"
 
 // Test counter
 int testsPassed = 0;
@@ -102,6 +109,49 @@ void testChordAnalyzerAmbiguous()
                "ChordAnalyzer: Interpretations sorted by confidence");
 }
 
+void testChordAnalyzerNinth()
+{
+    ChordAnalyzer analyzer;
+    std::vector<int> cmaj9{60, 64, 67, 71, 74};  // C-E-G-B-D
+
+    auto result = analyzer.analyzeChord(cmaj9, 60);
+
+    assertTrue(result.quality == ChordQuality::Maj9, "ChordAnalyzer: Major9 detection");
+    assertTrue(result.intervals == std::vector<int>({0, 2, 4, 7, 11}), "ChordAnalyzer: Major9 intervals sorted");
+}
+
+void testChordAnalyzerInversion()
+{
+    ChordAnalyzer analyzer;
+    std::vector<int> cmajorFirstInversion{64, 67, 72};  // E-G-C
+
+    auto result = analyzer.analyzeChord(cmajorFirstInversion, 0);
+
+    assertTrue(result.quality == ChordQuality::Major, "ChordAnalyzer: Inverted major triad detection");
+    assertTrue(result.root == 72, "ChordAnalyzer: Inverted major triad root");
+
+    // C-Eb-G-A reads as Am7b5 over C, or as C minor with an added 6th
+    std::vector<int> notes{60, 63, 67, 69};
+    auto interpretations = analyzer.analyzeChordAmbiguous(notes, 0);
+    assertTrue(interpretations.size() == 2 && interpretations[0].root == 69 &&
+               interpretations[0].quality == ChordQuality::HalfDim7,
+               "ChordAnalyzer: Ambiguous chord tries every root");
+}
+
+void testPitchClassSet()
+{
+    using scalechord::PitchClassSet;
+    PitchClassSet cmajor = PitchClassSet::fromNotes(std::vector<int>{60, 64, 67, 72});
+    PitchClassSet dmajor = cmajor.rotate(2);
+
+    assertTrue(cmajor.size() == 3 && cmajor.lowest() == 0, "PitchClassSet: Deduplicates octaves");
+    assertTrue(dmajor.toVector() == std::vector<int>({2, 6, 9}), "PitchClassSet: Rotate transposes");
+    assertTrue(cmajor.rotate(-3).rotate(3) == cmajor, "PitchClassSet: Rotate wraps");
+    assertTrue(cmajor.isSubsetOf(PitchClassSet(0x0AB5)) && !dmajor.isSubsetOf(PitchClassSet(0x0AB5)),
+               "PitchClassSet: Subset of C major scale");
+    assertTrue(cmajor.hammingDistance(dmajor) == 6, "PitchClassSet: Hamming distance");
+}
+
 void testChordAnalyzerQualityString()
 {
     const char* str = ChordAnalyzer::qualityToString(ChordQuality::Major7);
@@ -193,6 +243,156 @@ void testVoiceLeadingSuggest()
     assertTrue(result.totalDistance >= 0, "VoiceLeading: Distance non-negative");
 }
 
+void testVoiceLeadingExact()
+{
+    VoiceLeading vl;
+
+    // G7 -> C: the 7th and leading tone resolve by step, G is held, F drops out
+    auto resolved = vl.optimizeVoicing({55, 59, 62, 65}, {60, 64, 67}, 2);
+    assertTrue(resolved == std::vector<int>({55, 60, 64}), "VoiceLeading: G7 to C resolves minimally");
+
+    // Matches brute force over every voice-to-pitch-class assignment
+    uint32_t seed = 7;
+    auto nextRandom = [&seed](int range) {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<int>((seed >> 8) % static_cast<uint32_t>(range));
+    };
+    bool allOptimal = true;
+    for (int trial = 0; trial < 200; ++trial) {
+        int voices = 2 + nextRandom(5);
+        std::vector<int> from, to;
+        std::vector<int> pitches;
+        for (int i = 0; i < voices; ++i) from.push_back(40 + nextRandom(48));
+        while (static_cast<int>(pitches.size()) < voices) {
+            int pc = nextRandom(12);
+            if (std::find(pitches.begin(), pitches.end(), pc) == pitches.end()) pitches.push_back(pc);
+        }
+        for (int pc : pitches) to.push_back(60 + pc);
+
+        std::sort(pitches.begin(), pitches.end());
+        int bruteForce = 1 << 30;
+        do {
+            int total = 0;
+            for (int i = 0; i < voices; ++i) {
+                int d = ((pitches[i] - from[i]) % 12 + 12) % 12;
+                total += std::min(d, 12 - d);
+            }
+            bruteForce = std::min(bruteForce, total);
+        } while (std::next_permutation(pitches.begin(), pitches.end()));
+
+        auto voiced = vl.optimizeVoicing(from, to, 2);
+        std::sort(from.begin(), from.end());
+        int moved = 0;
+        for (int i = 0; i < voices; ++i) moved += std::abs(voiced[i] - from[i]);
+        allOptimal = allOptimal && static_cast<int>(voiced.size()) == voices && moved == bruteForce;
+    }
+    assertTrue(allOptimal, "VoiceLeading: Exact solver matches brute force");
+
+    // Allocation-free overload, more pitch classes than voices
+    int current[] = {60};
+    int target[] = {64, 67, 72};
+    int out[3];
+    int count = vl.optimizeVoicing(current, 1, target, 3, out, 2);
+    assertTrue(count == 3 && out[0] == 55 && out[1] == 60 && out[2] == 64,
+               "VoiceLeading: Extra pitch classes split off the nearest voice");
+}
+
+void testVoiceLeadingBatch()
+{
+    VoiceLeading vl;
+
+    // C-G (a fifth) moving up to D-A is parallel fifths; to D-B is not
+    float parallel = vl.scoreVoiceLeading({48, 55}, {50, 57});
+    float contrary = vl.scoreVoiceLeading({48, 55}, {50, 59});
+    assertTrue(parallel < contrary, "VoiceLeading: Parallel fifths are penalized");
+
+    // Batch scores match the single version for random sources and candidates
+    uint32_t seed = 99;
+    auto nextRandom = [&seed](int range) {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<int>((seed >> 8) % static_cast<uint32_t>(range));
+    };
+    bool allMatch = true;
+    for (int trial = 0; trial < 50; ++trial) {
+        std::vector<int> from;
+        int numFrom = 1 + nextRandom(VoiceLeading::BATCH_WIDTH);
+        for (int i = 0; i < numFrom; ++i) from.push_back(36 + nextRandom(48));
+
+        const int numCandidates = 1 + nextRandom(40);  // odd counts exercise the tail
+        std::vector<int8_t> rows(numCandidates * VoiceLeading::BATCH_WIDTH, -1);
+        std::vector<std::vector<int>> candidates(numCandidates);
+        for (int c = 0; c < numCandidates; ++c) {
+            int size = nextRandom(VoiceLeading::BATCH_WIDTH + 1);
+            for (int v = 0; v < size; ++v) {
+                // Mostly moves of a few semitones, so parallels actually occur
+                int note = v < numFrom && nextRandom(4) ? from[v] + nextRandom(9) - 4 : 30 + nextRandom(70);
+                candidates[c].push_back(note);
+                rows[c * VoiceLeading::BATCH_WIDTH + v] = static_cast<int8_t>(note);
+            }
+        }
+
+        std::vector<float> scores(numCandidates);
+        vl.scoreVoiceLeadingBatch(from.data(), numFrom, rows.data(), numCandidates, scores.data());
+        for (int c = 0; c < numCandidates; ++c) {
+            allMatch = allMatch && scores[c] == vl.scoreVoiceLeading(from, candidates[c]);
+        }
+    }
+    assertTrue(allMatch, "VoiceLeading: Batch scores match single scores");
+}
+
+void testProgressionVoicer()
+{
+    ProgressionVoicerSettings whole;
+    whole.segmentLength = 0;
+    ProgressionVoicer voicer(whole);
+
+    // ii-V-I-vi written with big register jumps
+    std::vector<std::vector<int>> written = {
+        {50, 53, 57, 60}, {67, 71, 74, 77}, {48, 52, 55, 59}, {69, 72, 76, 79}};
+    std::vector<std::vector<int>> tune;
+    for (int i = 0; i < 40; ++i) tune.insert(tune.end(), written.begin(), written.end());
+
+    auto result = voicer.optimize(tune);
+    bool samePitches = result.voicings.size() == tune.size();
+    bool inRange = true;
+    for (size_t i = 0; samePitches && i < tune.size(); ++i) {
+        const auto& v = result.voicings[i];
+        samePitches = !v.empty() &&
+                      scalechord::PitchClassSet::fromNotes(v) == scalechord::PitchClassSet::fromNotes(tune[i]) &&
+                      v[0] % 12 == tune[i][0] % 12;
+        inRange = inRange && v.front() >= 40 && v.back() <= 84;
+    }
+    assertTrue(samePitches, "ProgressionVoicer: Keeps pitch classes and bass");
+    assertTrue(inRange, "ProgressionVoicer: Voicings stay in range");
+    assertTrue(std::fabs(voicer.scoreVoicings(result.voicings) - result.totalCost) < 1e-3f,
+               "ProgressionVoicer: Reported cost matches the voicings");
+    assertTrue(result.totalCost < voicer.scoreVoicings(tune) * 0.5f,
+               "ProgressionVoicer: Much smoother than the written voicing");
+
+    // Parallel segments give the same result as optimizing each slice alone
+    ProgressionVoicerSettings settings;
+    settings.segmentLength = 24;
+    settings.maxThreads = 4;
+    ProgressionVoicer segmented(settings);
+    auto parallel = segmented.optimize(tune);
+
+    ProgressionVoicer single(whole);
+    bool matches = parallel.segmentCount == 7;
+    for (size_t begin = 0; matches && begin < tune.size(); begin += 24) {
+        std::vector<std::vector<int>> slice(tune.begin() + begin,
+                                            tune.begin() + std::min(tune.size(), begin + 24));
+        auto alone = single.optimize(slice);
+        matches = std::equal(alone.voicings.begin(), alone.voicings.end(), parallel.voicings.begin() + begin);
+    }
+    assertTrue(matches, "ProgressionVoicer: Parallel segments are independent");
+
+    // Rests stay empty and break voice leading
+    auto withRest = voicer.optimize({{60, 64, 67}, {}, {65, 69, 72}});
+    assertTrue(withRest.voicings.size() == 3 && withRest.voicings[1].empty() &&
+               withRest.voicings[2].size() == 3,
+               "ProgressionVoicer: Rests stay empty");
+}
+
 // ============================================================================
 // JAZZ REHARMONIZER TESTS
 // ============================================================================
@@ -214,6 +414,40 @@ void testJazzReharmonizerSubstitutions()
     assertTrue(hasTritone, "JazzReharmonizer: V chord suggestions have good musicality");
 }
 
+void testJazzReharmonizerCatalogue()
+{
+    JazzReharmonizer jazz;
+
+    // Every degree's view is sorted and points into the same static table
+    bool sorted = true;
+    size_t total = 0;
+    for (int key = 0; key < 2; ++key) {
+        for (int degree = 0; degree < 7; ++degree) {
+            SubstitutionSpan subs = jazz.getSubstitutions(degree, key == 0);
+            total += subs.size();
+            for (size_t i = 0; i < subs.size(); ++i) {
+                sorted = sorted && subs[i].degree == degree &&
+                         (i == 0 || subs[i - 1].musicality >= subs[i].musicality);
+            }
+        }
+    }
+    assertTrue(sorted && total == JazzReharmonizer::getCatalogue().size(),
+               "JazzReharmonizer: Catalogue grouped by degree, best first");
+    assertTrue(jazz.getSubstitutions(4, true).begin() == jazz.getSubstitutions(11, true).begin(),
+               "JazzReharmonizer: Lookups share static storage");
+
+    bool kinds[6] = {};
+    for (const Substitution& sub : JazzReharmonizer::getCatalogue()) kinds[static_cast<int>(sub.kind)] = true;
+    assertTrue(std::all_of(std::begin(kinds), std::end(kinds), [](bool k) { return k; }),
+               "JazzReharmonizer: Catalogue covers every substitution kind");
+
+    bool tritone = false;
+    for (const Substitution& sub : jazz.getSubstitutions(4, true)) {
+        tritone = tritone || (sub.kind == SubstitutionKind::Tritone && sub.rootOffset == 6);
+    }
+    assertTrue(tritone, "JazzReharmonizer: V offers the tritone substitute a tritone away");
+}
+
 void testJazzReharmonizerTritone()
 {
     JazzReharmonizer jazz;
@@ -261,6 +495,119 @@ void testJazzReharmonizerUpperStructure()
     assertTrue(upper[0] == 67, "JazzReharmonizer: Upper structure keeps bass note");
 }
 
+void testProgressionReharmonizer()
+{
+    ReharmonizerSettings exact;
+    exact.beamWidth = ProgressionReharmonizer::MAX_OPTIONS;  // keeps every option: exact search
+    exact.maxThreads = 1;
+    ProgressionReharmonizer reharmonizer(exact);
+
+    // ii-V-I-vi in C, eight-bar sections
+    std::vector<std::vector<int>> written = {
+        {62, 65, 69, 72}, {55, 59, 62, 65}, {60, 64, 67, 71}, {57, 60, 64, 67}};
+    std::vector<TimelineChord> timeline;
+    for (int i = 0; i < 32; ++i) {
+        TimelineChord chord;
+        chord.ppq = 4.0 * i;
+        chord.notes = written[i % 4];
+        chord.sectionStart = i % 8 == 0;
+        timeline.push_back(chord);
+    }
+
+    const SubstitutionSpan catalogue = JazzReharmonizer::getCatalogue();
+    auto fromCatalogue = [&](const Substitution* sub) {
+        return sub == nullptr || (sub >= catalogue.begin() && sub < catalogue.end());
+    };
+
+    auto result = reharmonizer.reharmonize(timeline);
+    bool valid = result.chords.size() == timeline.size() && result.sectionCount == 4;
+    bool substituted = false;
+    for (size_t i = 0; valid && i < timeline.size(); ++i) {
+        const ReharmonizedChord& chord = result.chords[i];
+        valid = chord.ppq == timeline[i].ppq && !chord.notes.empty() &&
+                std::is_sorted(chord.notes.begin(), chord.notes.end()) && fromCatalogue(chord.substitution);
+        if (valid && chord.substitution == nullptr) valid = chord.notes == timeline[i].notes;
+        substituted = substituted || chord.substitution != nullptr;
+    }
+    assertTrue(valid, "ProgressionReharmonizer: One valid chord per timeline chord");
+    assertTrue(substituted, "ProgressionReharmonizer: Substitutes chords in context");
+
+    ReharmonizerSettings greedySettings = exact;
+    greedySettings.beamWidth = 1;
+    auto greedy = ProgressionReharmonizer(greedySettings).reharmonize(timeline);
+    assertTrue(result.totalScore >= greedy.totalScore - 1e-3f,
+               "ProgressionReharmonizer: Search scores at least as well as greedy");
+
+    ReharmonizerSettings faithful = exact;
+    faithful.originalMusicality = 1000.0f;
+    auto kept = ProgressionReharmonizer(faithful).reharmonize(timeline);
+    bool allKept = true;
+    for (size_t i = 0; i < timeline.size(); ++i) {
+        allKept = allKept && kept.chords[i].substitution == nullptr && kept.chords[i].notes == timeline[i].notes;
+    }
+    assertTrue(allKept, "ProgressionReharmonizer: Keeps the written chords when they score best");
+
+    // Parallel sections give the same result as reharmonizing each alone
+    ReharmonizerSettings threaded = exact;
+    threaded.maxThreads = 4;
+    auto parallel = ProgressionReharmonizer(threaded).reharmonize(timeline);
+    bool matches = parallel.sectionCount == 4 && std::fabs(parallel.totalScore - result.totalScore) < 1e-2f;
+    for (size_t begin = 0; matches && begin < timeline.size(); begin += 8) {
+        std::vector<TimelineChord> section(timeline.begin() + begin, timeline.begin() + begin + 8);
+        auto alone = reharmonizer.reharmonize(section);
+        for (size_t i = 0; matches && i < section.size(); ++i) {
+            matches = alone.chords[i].notes == parallel.chords[begin + i].notes &&
+                      alone.chords[i].substitution == parallel.chords[begin + i].substitution;
+        }
+    }
+    assertTrue(matches, "ProgressionReharmonizer: Parallel sections are independent");
+
+    // Real time: one chord at a time into a caller buffer
+    ProgressionReharmonizer live(exact);
+    bool liveValid = true;
+    for (const TimelineChord& chord : timeline) {
+        int out[ProgressionReharmonizer::MAX_NOTES];
+        const Substitution* chosen = nullptr;
+        int count = live.nextChord(chord.notes.data(), static_cast<int>(chord.notes.size()), out, &chosen);
+        liveValid = liveValid && count > 0 && count <= ProgressionReharmonizer::MAX_NOTES &&
+                    std::is_sorted(out, out + count) && fromCatalogue(chosen);
+    }
+    assertTrue(liveValid, "ProgressionReharmonizer: nextChord extends the progression in real time");
+
+    // New weights take effect on memoized transitions too. The chromatic Ab
+    // chord is always kept, so the transitions out of it are served from the
+    // memo filled under the old weights.
+    const std::vector<std::vector<int>> chromatic = {
+        {56, 60, 63}, {62, 65, 69, 72}, {56, 60, 63}, {55, 59, 62, 65}};
+    ReharmonizerSettings smooth = exact;
+    smooth.smoothnessWeight = 4.0f;
+    smooth.resolutionBonus = 0.0f;
+    smooth.originalMusicality = 80.0f;
+    ReharmonizerSettings staticOnly = smooth;
+    staticOnly.smoothnessWeight = 0.0f;
+
+    ProgressionReharmonizer reweighted(smooth);
+    ProgressionReharmonizer fresh(staticOnly);
+    int a[ProgressionReharmonizer::MAX_NOTES], b[ProgressionReharmonizer::MAX_NOTES];
+    for (int i = 0; i < 16; ++i) reweighted.nextChord(chromatic[i % 4].data(), static_cast<int>(chromatic[i % 4].size()), a);
+    reweighted.setSettings(staticOnly);
+    reweighted.reset();
+    bool sameAsFresh = true;
+    for (int i = 0; i < 16; ++i) {
+        const std::vector<int>& chord = chromatic[i % 4];
+        const Substitution* chosenA = nullptr;
+        const Substitution* chosenB = nullptr;
+        int countA = reweighted.nextChord(chord.data(), static_cast<int>(chord.size()), a, &chosenA);
+        int countB = fresh.nextChord(chord.data(), static_cast<int>(chord.size()), b, &chosenB);
+        sameAsFresh = sameAsFresh && chosenA == chosenB && countA == countB && std::equal(a, a + countA, b);
+    }
+    assertTrue(sameAsFresh, "ProgressionReharmonizer: Weight changes invalidate memoized transitions");
+
+    int out[ProgressionReharmonizer::MAX_NOTES];
+    live.reset();
+    assertTrue(live.nextChord(nullptr, 0, out) == 0, "ProgressionReharmonizer: Rests produce no notes");
+}
+
 // ============================================================================
 // INTEGRATION TESTS
 // ============================================================================
@@ -332,6 +679,9 @@ int main()
     testChordAnalyzerMajor7();
     testChordAnalyzerFunction();
     testChordAnalyzerAmbiguous();
+    testChordAnalyzerNinth();
+    testChordAnalyzerInversion();
+    testPitchClassSet();
     testChordAnalyzerQualityString();
     
     // VoiceLeading Tests
@@ -342,14 +692,19 @@ int main()
     testVoiceLeadingOptimize();
     testVoiceLeadingSmoothness();
     testVoiceLeadingSuggest();
+    testVoiceLeadingExact();
+    testVoiceLeadingBatch();
+    testProgressionVoicer();
     
     // JazzReharmonizer Tests
     std::cout << "\nJazzReharmonizer Tests:\n";
     testJazzReharmonizerSubstitutions();
+    testJazzReharmonizerCatalogue();
     testJazzReharmonizerTritone();
     testJazzReharmonizerSecondaryDominant();
     testJazzReharmonizerParallel();
     testJazzReharmonizerUpperStructure();
+    testProgressionReharmonizer();
     
     // Integration Tests
     std::cout << "\nIntegration Tests:\n";
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/MIDIEffects.h"
+#include "../include/FastRandom.h"
+#include "../include/GrooveTemplate.h"
+
+using namespace scalechord;
+
+// Test counter
+int testsPassed = 0;
+int testsFailed = 0;
+
+void assertTrue(bool condition, const char* testName)
+{
+    if (condition) {
+        std::cout << "✓ " << testName << std::endl;
+        testsPassed++;
+    } else {
+        std::cout << "✗ " << testName << std::endl;
+        testsFailed++;
+    }
+}
+
+// Records processBlock() output as {on?, note, absolute sample}
+struct RecordingSink : EventSink {
+    std::vector<std::array<int64_t, 3>> events;
+    int64_t blockStart = 0;
+    void noteOn(int note, int, int offset) override { events.push_back({1, note, blockStart + offset}); }
+    void noteOff(int note, int offset) override { events.push_back({0, note, blockStart + offset}); }
+};
+
+// ============================================================================
+// ARPEGGIATOR TESTS
+// ============================================================================
+
+void testArpeggiatorUpDown()
+{
+    ArpeggiatorSettings as;
+    as.mode = ArpeggiatorMode::UpDown;
+    as.sync = ArpeggiatorSync::Freerun;
+    as.tempoHz = 1000.0f;   // one step per process() call at 1 kHz
+    as.octaveRange = 2;
+    Arpeggiator arp(as);
+    arp.setChordNotes({67, 60, 64});
+
+    std::vector<int> played;
+    for (int i = 0; i < 10; ++i) played.push_back(arp.process(1000.0f));
+
+    assertTrue(arp.getPatternLength() == 9, "Arpeggiator: UpDown pattern length over two octaves");
+    assertTrue(played == std::vector<int>({64, 67, 72, 76, 79, 67, 64, 60, 60, 64}),
+               "Arpeggiator: UpDown walks octaves in order");
+}
+
+void testArpeggiatorRandomCycle()
+{
+    ArpeggiatorSettings as;
+    as.mode = ArpeggiatorMode::Random;
+    as.sync = ArpeggiatorSync::Freerun;
+    as.tempoHz = 1000.0f;
+    Arpeggiator arp(as);
+    arp.setChordNotes({67, 60, 64});
+    arp.process(1000.0f);   // steps start at index 1; line up with the next cycle
+    arp.process(1000.0f);
+
+    bool everyNoteOnce = true;
+    for (int cycle = 0; cycle < 4; ++cycle) {
+        std::vector<int> notes;
+        for (int i = 0; i < 3; ++i) notes.push_back(arp.process(1000.0f));
+        std::sort(notes.begin(), notes.end());
+        everyNoteOnce = everyNoteOnce && notes == std::vector<int>({60, 64, 67});
+    }
+    assertTrue(everyNoteOnce, "Arpeggiator: Random plays every chord note once per cycle");
+}
+
+// 16ths at 120 bpm / 48 kHz are 6000 samples; swing 0.6 puts odd steps 1200 late
+Arpeggiator makeSwungArpeggiator()
+{
+    ArpeggiatorSettings as;
+    as.mode = ArpeggiatorMode::Up;
+    as.sync = ArpeggiatorSync::Tempo16th;
+    as.swing = 0.6f;
+    as.gate = 0.5f;
+    Arpeggiator arp(as);
+    arp.setChordNotes({60, 64, 67});
+    return arp;
+}
+
+void testArpeggiatorBlockTiming()
+{
+    Arpeggiator arp = makeSwungArpeggiator();
+    RecordingSink sink;
+    PlayheadInfo playhead;
+    playhead.bpm = 120.0;
+    playhead.sampleRate = 48000.0;
+    for (int64_t start = 0; start < 13000; start += 512) {
+        playhead.ppqPosition = start / 24000.0;
+        sink.blockStart = start;
+        arp.processBlock(playhead, 512, sink);
+    }
+
+    const std::vector<std::array<int64_t, 3>> expected{
+        {1, 60, 0}, {0, 60, 3000}, {1, 64, 7200}, {0, 64, 10200}, {1, 67, 12000}};
+    assertTrue(sink.events == expected, "Arpeggiator: steps land on exact samples from the host PPQ, with swing");
+}
+
+void testArpeggiatorLoopRelock()
+{
+    Arpeggiator arp = makeSwungArpeggiator();
+    RecordingSink sink;
+    PlayheadInfo playhead;
+    playhead.bpm = 120.0;
+    playhead.sampleRate = 48000.0;
+    for (int64_t start = 0; start < 13000; start += 512) {
+        playhead.ppqPosition = start / 24000.0;
+        arp.processBlock(playhead, 512, sink);
+    }
+
+    // Loop back to bar start: the sounding note ends and step 0 replays
+    sink.events.clear();
+    sink.blockStart = 0;
+    playhead.ppqPosition = 0.0;
+    arp.processBlock(playhead, 512, sink);
+    assertTrue(sink.events == std::vector<std::array<int64_t, 3>>({{0, 67, 0}, {1, 60, 0}}),
+               "Arpeggiator: a host loop re-locks the phase");
+}
+
+void testArpeggiatorTempoRamp()
+{
+    ArpeggiatorSettings as;
+    as.mode = ArpeggiatorMode::Up;
+    as.sync = ArpeggiatorSync::Tempo16th;
+    as.gate = 0.5f;
+    Arpeggiator arp(as);
+    arp.setChordNotes({60, 64, 67});
+
+    // Host ramps 120 -> 180 bpm over 200 blocks; it reports the tempo at each
+    // block start but advances by the average tempo over the block
+    RecordingSink sink;
+    PlayheadInfo playhead;
+    playhead.sampleRate = 48000.0;
+    double ppq = 0.0;
+    for (int block = 0; block < 200; ++block) {
+        const double bpmStart = 120.0 + 0.3 * block;
+        playhead.bpm = bpmStart;
+        playhead.ppqPosition = ppq;
+        sink.blockStart = block * 512;
+        arp.processBlock(playhead, 512, sink);
+        ppq += 512 * (bpmStart + 0.15) / (60.0 * 48000.0);
+    }
+
+    // Every 16th plays once, in order, and lasts its full gate (2000+ samples
+    // even at 180 bpm) instead of being cut at the next block start
+    bool ok = !sink.events.empty();
+    int steps = 0;
+    for (size_t i = 0; i < sink.events.size(); ++i) {
+        const auto& e = sink.events[i];
+        if (e[0] == 1) {
+            ok = ok && (i % 2 == 0) && e[1] == std::array<int, 3>{60, 64, 67}[steps % 3];
+            ++steps;
+        } else {
+            ok = ok && (i % 2 == 1) && e[1] == sink.events[i - 1][1] &&
+                 e[2] - sink.events[i - 1][2] >= 1900;
+        }
+    }
+    assertTrue(ok && steps == static_cast<int>(std::floor(ppq / 0.25)) + 1,
+               "Arpeggiator: a tempo ramp is not mistaken for a relocate");
+}
+
+// ============================================================================
+// SEEDED RANDOMNESS TESTS
+// ============================================================================
+
+void testHumanizerSeed()
+{
+    HumanizerSettings hs;
+    hs.enabled = true;
+    hs.velocityVariation = 0.3f;
+    Humanizer a(hs), b(hs);
+    a.setSeed(42);
+    b.setSeed(42);
+    bool same = true;
+    for (int i = 0; i < 64; ++i) same = same && a.humanizeVelocity(100) == b.humanizeVelocity(100);
+    assertTrue(same, "Humanizer: same seed gives the same velocities");
+}
+
+void testFastRandomBatch()
+{
+    FastRandom rng(7), copy(7);
+    float batch[16];
+    rng.fillUniform(batch, 16);
+    bool inRange = true, matches = true;
+    for (float u : batch) {
+        inRange = inRange && u >= 0.0f && u < 1.0f;
+        matches = matches && u == copy.nextFloat();
+    }
+    assertTrue(inRange, "FastRandom: fillUniform stays in [0, 1)");
+    assertTrue(matches, "FastRandom: fillUniform matches nextFloat()");
+}
+
+void testFastRandomSeeds()
+{
+    assertTrue(FastRandom(1).next() != FastRandom(2).next(), "FastRandom: different seeds give different streams");
+}
+
+// ============================================================================
+// GROOVE TEMPLATE TESTS
+// ============================================================================
+
+// Format 0, 96 ticks/quarter; 16ths where every off-beat is 8 ticks late and softer
+std::string makeSwungMidiFile()
+{
+    std::string smf("MThd\0\0\0\6\0\0\0\1\0\x60", 14);
+    std::string track;
+    for (int i = 0; i < 16; ++i) {
+        const bool offBeat = i & 1;
+        track += std::string(1, static_cast<char>(offBeat ? 8 : 0));            // delta to note-on
+        if (i == 0) track += '\x90';                                             // then running status
+        track += '\x3C';
+        track += static_cast<char>(offBeat ? 60 : 100);
+        track += std::string(1, static_cast<char>(offBeat ? 16 : 24));          // delta to note-off
+        track += std::string("\x3C\0", 2);
+    }
+    track += std::string("\0\xFF\x2F\0", 4);
+    const uint32_t trackLength = static_cast<uint32_t>(track.size());
+    smf += "MTrk";
+    for (int shift = 24; shift >= 0; shift -= 8) smf += static_cast<char>((trackLength >> shift) & 0xFF);
+    smf += track;
+    return smf;
+}
+
+// Four-step groove extracted from makeSwungMidiFile(); false if that fails
+bool extractSwungGroove(GrooveTemplate& groove)
+{
+    std::vector<GrooveNote> notes;
+    return GrooveTemplate::parseMidiFile(makeSwungMidiFile(), notes) && notes.size() == 16 &&
+           GrooveTemplate::extract(notes, 4, groove);
+}
+
+void testGrooveTemplateExtract()
+{
+    GrooveTemplate groove;
+    const bool extracted = extractSwungGroove(groove);
+    assertTrue(extracted, "GrooveTemplate: parses and extracts a swung performance");
+    assertTrue(extracted && std::fabs(groove.getTimingOffset(1) - 1.0f / 3.0f) < 1e-4f &&
+               groove.getTimingOffset(2) == 0.0f,
+               "GrooveTemplate: off-beat timing offsets");
+    assertTrue(extracted && std::fabs(groove.getVelocityScale(3) - 0.75f) < 1e-4f,
+               "GrooveTemplate: off-beat velocity scale");
+}
+
+void testGrooveTemplateBinary()
+{
+    GrooveTemplate groove, restored;
+    const bool ok = extractSwungGroove(groove) && GrooveTemplate::fromBinary(groove.toBinary(), restored);
+    assertTrue(ok && restored.getLength() == 4 &&
+               std::fabs(restored.getTimingOffset(3) - groove.getTimingOffset(3)) < 0.005f &&
+               restored.getVelocityScale(0) == 1.25f,
+               "GrooveTemplate: binary round trip");
+}
+
+void testGrooveTemplateTighten()
+{
+    GrooveTemplate groove;
+    const bool extracted = extractSwungGroove(groove);
+    assertTrue(extracted && std::fabs(groove.tighten(0.26, 1.0f, 0.05) - 0.31) < 1e-9,
+               "GrooveTemplate: full-strength tighten snaps to the groove");
+    assertTrue(extracted && std::fabs(groove.tighten(0.26, 0.5f, 0.05) - (0.26 + (1.0 / 3.0 - 0.26) * 0.5)) < 1e-6,
+               "GrooveTemplate: half-strength tighten moves halfway");
+}
+
+void testHumanizerGroove()
+{
+    GrooveTemplate groove;
+    const bool extracted = extractSwungGroove(groove);
+    HumanizerSettings hs;
+    hs.enabled = true;
+    Humanizer humanizer(hs);
+    humanizer.setGroove(groove);
+    assertTrue(extracted && std::fabs(humanizer.grooveTimingQn(4.25) - 1.0 / 12.0) < 1e-6,
+               "Humanizer: groove timing by lookup");
+    assertTrue(extracted && humanizer.grooveVelocity(100, 4.75) == 75 && humanizer.grooveVelocity(100, 5.0) == 125,
+               "Humanizer: groove velocity by lookup");
+}
+
+// ============================================================================
+// MAIN TEST RUNNER
+// ============================================================================
+
+int main()
+{
+    std::cout << "\n=== MIDI Effects Tests ===\n";
+
+    // Arpeggiator Tests
+    std::cout << "\nArpeggiator Tests:\n";
+    testArpeggiatorUpDown();
+    testArpeggiatorRandomCycle();
+    testArpeggiatorBlockTiming();
+    testArpeggiatorLoopRelock();
+    testArpeggiatorTempoRamp();
+
+    // Seeded Randomness Tests
+    std::cout << "\nSeeded Randomness Tests:\n";
+    testHumanizerSeed();
+    testFastRandomBatch();
+    testFastRandomSeeds();
+
+    // GrooveTemplate Tests
+    std::cout << "\nGrooveTemplate Tests:\n";
+    testGrooveTemplateExtract();
+    testGrooveTemplateBinary();
+    testGrooveTemplateTighten();
+    testHumanizerGroove();
+
+    // Summary
+    std::cout << "\n=== Test Summary ===\n";
+    std::cout << "Passed: " << testsPassed << std::endl;
+    std::cout << "Failed: " << testsFailed << std::endl;
+
+    if (testsFailed == 0) {
+        std::cout << "\n✓ All tests passed!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n✗ Some tests failed!\n\n";
+        return 1;
+    }
+}
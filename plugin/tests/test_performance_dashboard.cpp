@@ -2,6 +2,7 @@
 #include <cmath>
 #include <vector>
 #include "../include/PerformanceDashboard.h"
+#include "../include/VoiceAllocator.h"
 
 using namespace scalechord;
 
@@ -401,6 +402,66 @@ bool test_reset_peak_hold() {
     return true;
 }
 
+// ========== Voice Allocation Tests ==========
+
+bool test_voice_allocator_budget() {
+    VoiceAllocatorSettings settings;
+    settings.maxVoices = 4;
+    VoiceAllocator allocator(settings);
+
+    for (int note = 60; note < 64; ++note) {
+        if (allocator.noteOn(note, 100).stolenNote != -1) return false;
+    }
+    // Fifth note steals the oldest (60); its note-off is then suppressed
+    VoiceAllocation stolen = allocator.noteOn(64, 100);
+    return stolen.stolenNote == 60 && allocator.getActiveVoiceCount() == 4 &&
+           !allocator.noteOff(60) && allocator.noteOff(61) && allocator.getStealCount() == 1;
+}
+
+bool test_voice_allocator_policies() {
+    VoiceAllocatorSettings settings;
+    settings.maxVoices = 3;
+    const StealPolicy policies[] = {StealPolicy::Quietest, StealPolicy::Highest, StealPolicy::Lowest};
+    const int expected[] = {67, 72, 60};
+
+    for (int i = 0; i < 3; ++i) {
+        settings.policy = policies[i];
+        VoiceAllocator allocator(settings);
+        allocator.noteOn(64, 100);
+        allocator.noteOn(72, 90);
+        allocator.noteOn(60, 110);
+        allocator.noteOff(64);
+        allocator.noteOn(67, 40);
+        if (allocator.noteOn(65, 100).stolenNote != expected[i]) return false;
+    }
+
+    // Same pitch reuses its voice instead of stealing
+    VoiceAllocator allocator(settings);
+    allocator.noteOn(60, 100);
+    VoiceAllocation again = allocator.noteOn(60, 80);
+    return again.samePitchReuse && again.stolenNote == 60 &&
+           allocator.getActiveVoiceCount() == 1 && allocator.getStealCount() == 0;
+}
+
+bool test_voice_steal_metrics() {
+    PerformanceDashboard dashboard;
+    dashboard.initialize(44100, 256);
+
+    VoiceAllocatorSettings settings;
+    settings.maxVoices = 2;
+    VoiceAllocator allocator(settings);
+    for (int note = 60; note < 65; ++note) allocator.noteOn(note, 100);
+
+    bool voiceStates[PerformanceDashboard::MAX_VOICES];
+    allocator.getVoiceStates(voiceStates, PerformanceDashboard::MAX_VOICES);
+    dashboard.updateVoiceMetrics(allocator.getActiveVoiceCount(), voiceStates);
+    dashboard.updateVoiceSteals(allocator.getStealCount());
+
+    auto voices = dashboard.getVoiceMetrics();
+    return voices.stealCount == 3 && voices.activeVoiceCount == 2 &&
+           voices.voiceActivity[0] && voices.voiceActivity[1] && !voices.voiceActivity[2];
+}
+
 // ========== Status String Test ==========
 
 bool test_status_string() {
@@ -448,6 +509,15 @@ int main() {
     total++; passed += test_voice_metrics_average() ? 1 : 0;
     printTestResult("Voice metrics average", test_voice_metrics_average());
     
+    total++; passed += test_voice_allocator_budget() ? 1 : 0;
+    printTestResult("Voice allocator budget", test_voice_allocator_budget());
+    
+    total++; passed += test_voice_allocator_policies() ? 1 : 0;
+    printTestResult("Voice allocator policies", test_voice_allocator_policies());
+    
+    total++; passed += test_voice_steal_metrics() ? 1 : 0;
+    printTestResult("Voice steal metrics", test_voice_steal_metrics());
+    
     // CPU metrics
     std::cout << "\nCPU Metrics:" << std::endl;
     total++; passed += test_cpu_metrics_update() ? 1 : 0;
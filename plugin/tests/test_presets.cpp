@@ -322,6 +322,7 @@ int main() {
         original.envelopeSettings.humanize = true;
         original.midiEffects.arpeggiatorEnabled = true;
         original.midiEffects.arpeggiatorMode = 3;
+        original.midiEffects.randomSeed = 1234567;
         
         // Serialize
         std::string json = PresetManager::presetToJson(original);
@@ -339,6 +340,7 @@ int main() {
         ASSERT(restored.envelopeSettings.humanize == original.envelopeSettings.humanize);
         ASSERT(restored.midiEffects.arpeggiatorEnabled == original.midiEffects.arpeggiatorEnabled);
         ASSERT(restored.midiEffects.arpeggiatorMode == original.midiEffects.arpeggiatorMode);
+        ASSERT(restored.midiEffects.randomSeed == original.midiEffects.randomSeed);
         
         END_TEST();
     }
@@ -1,7 +1,22 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <thread>
+#include <vector>
 #include "../include/ScaleMapper.h"
 #include "../include/ChordVoicer.h"
+#include "../include/ScaleTables.h"
+#include "../include/MicrotonalMapper.h"
+#include "../include/KeyTracker.h"
+#include "../include/NoteTracker.h"
+#include "../include/MidiOutputStage.h"
+#include "../include/EventScheduler.h"
+#include "../include/EnvelopeBank.h"
+#include "../include/ModulationOutput.h"
 
 using namespace scalechord;
 
@@ -31,6 +46,577 @@ int main() {
         return 3;
     }
 
+    // Allocation-free voicing gives the expected C major voicings
+    struct ExpectedVoicing { VoicingType voicing; int octaveOffset; int note; std::vector<int> chord; };
+    const ExpectedVoicing expectedVoicings[] = {
+        {VoicingType::Triad,    0, 60, {60, 64, 67}},
+        {VoicingType::Triad,    0, 71, {71, 74, 77}},
+        {VoicingType::Triad,   -1, 60, {48, 52, 55}},
+        {VoicingType::Seventh,  0, 60, {60, 64, 67, 71}},
+        {VoicingType::Seventh,  0, 69, {69, 72, 76, 79}},
+        {VoicingType::Open,     0, 60, {60, 64, 79}},
+        {VoicingType::Open,     0, 65, {65, 69, 84}},
+    };
+    ChordBuffer buffer;
+    for (const ExpectedVoicing& expected : expectedVoicings) {
+        VoicerSettings settings; settings.voicing = expected.voicing; settings.octaveOffset = expected.octaveOffset;
+        voicer.setSettings(settings);
+        voicer.makeChordInto(expected.note, buffer);
+        if (buffer.toVector() != expected.chord) {
+            std::cerr << "makeChordInto wrong voicing for " << expected.note << "\n";
+            return 6;
+        }
+    }
+    voicer.setSettings(vs);
+
+    // Cached voicings track both voicer and mapper settings changes
+    for (int pass = 0; pass < 3; ++pass) {
+        if (pass == 1) {
+            VoicerSettings seventh; seventh.voicing = VoicingType::Seventh; seventh.octaveOffset = -1;
+            voicer.setSettings(seventh);
+        } else if (pass == 2) {
+            MapperSettings dorian; dorian.rootNote = 2; dorian.scale = ScaleType::Dorian;
+            mapper.setSettings(dorian);
+        }
+        for (int note = 0; note < 128; ++note) {
+            if (voicer.getCachedChord(note).toVector() != voicer.makeChordFromNote(note)) {
+                std::cerr << "Cached chord stale for " << note << " (pass " << pass << ")\n";
+                return 7;
+            }
+        }
+    }
+
+    // Static tables: every scale/root maps every note into the scale, and
+    // switching settings swaps to the matching table
+    for (int s = 0; s < NUM_SCALE_TYPES; ++s) {
+        for (int root = 0; root < 12; ++root) {
+            MapperSettings settings;
+            settings.scale = static_cast<ScaleType>(s);
+            settings.rootNote = root;
+            mapper.setSettings(settings);
+            if (&mapper.getScaleTable() != &scaleTable(settings.scale, root)) {
+                std::cerr << "Scale table not swapped for scale " << s << "\n";
+                return 4;
+            }
+            for (int note = 0; note < 128; ++note) {
+                int mapped = mapper.mapNoteFast(note);
+                if (mapper.getScaleDegree(mapped) < 0 || std::abs(mapped - note) > 6) {
+                    std::cerr << "Bad mapping " << note << " -> " << mapped << "\n";
+                    return 5;
+                }
+            }
+        }
+    }
+
+    // Batch mapping agrees with the per-note path for every byte value,
+    // including lengths that exercise the SIMD body and the scalar tail
+    {
+        uint8_t in[256 + 7], out[256 + 7];
+        for (int i = 0; i < 256 + 7; ++i) in[i] = static_cast<uint8_t>(i * 37 + 11);
+        int ints[256 + 7], intsOut[256 + 7];
+        for (int i = 0; i < 256 + 7; ++i) ints[i] = i - 40;
+        for (int s = 0; s < NUM_SCALE_TYPES; ++s) {
+            MapperSettings settings;
+            settings.scale = static_cast<ScaleType>(s);
+            settings.rootNote = s % 12;
+            mapper.setSettings(settings);
+            mapper.mapNotes(in, out, sizeof(in));
+            mapper.mapNotes(ints, intsOut, sizeof(in));
+            for (size_t i = 0; i < sizeof(in); ++i) {
+                if (out[i] != mapper.mapNoteFast(in[i]) || intsOut[i] != mapper.mapNoteFast(ints[i])) {
+                    std::cerr << "mapNotes mismatch at " << i << "\n";
+                    return 8;
+                }
+            }
+
+            // Every SIMD path the CPU supports matches the scalar path
+            uint8_t scalar[256 + 7], simd[256 + 7];
+            mapper.mapNotes(in, scalar, sizeof(in), ScaleMapper::SimdPath::Scalar);
+            for (auto path : {ScaleMapper::SimdPath::SSSE3, ScaleMapper::SimdPath::AVX2}) {
+                if (path > ScaleMapper::bestSimdPath()) continue;
+                for (size_t length : {sizeof(in), size_t(16), size_t(31), size_t(47)}) {
+                    mapper.mapNotes(in, simd, length, path);
+                    if (!std::equal(simd, simd + length, scalar)) {
+                        std::cerr << "mapNotes SIMD path " << static_cast<int>(path) << " differs from scalar\n";
+                        return 8;
+                    }
+                }
+            }
+        }
+    }
+
+    // Settings published from another thread while this one voices chords:
+    // every chord read must be a complete, sorted voicing
+    {
+        std::atomic<bool> done{false};
+        std::thread writer([&]() {
+            for (int i = 0; i < 2000; ++i) {
+                MapperSettings ms2;
+                ms2.rootNote = i % 12;
+                ms2.scale = static_cast<ScaleType>(i % NUM_SCALE_TYPES);
+                mapper.setSettings(ms2);
+                VoicerSettings vs2;
+                vs2.voicing = (i & 1) ? VoicingType::Seventh : VoicingType::Triad;
+                voicer.setSettings(vs2);
+            }
+            done = true;
+        });
+        bool ok = true;
+        while (!done) {
+            for (int note = 0; note < 128; ++note) {
+                ChordBuffer chord = voicer.getCachedChord(note);
+                if (chord.size() < 3 || chord.size() > 4 ||
+                    !std::is_sorted(chord.begin(), chord.end())) {
+                    ok = false;
+                }
+            }
+        }
+        writer.join();
+        if (!ok) {
+            std::cerr << "Torn voicing observed during concurrent settings change\n";
+            return 9;
+        }
+    }
+
+    // Microtonal: 12-EDO is the identity, 19-EDO quantizes within half a step,
+    // and a just-intonation .scl parses ratios and cents
+    {
+        MicrotonalMapper micro;
+        for (int note = 0; note < 128; ++note) {
+            RetunedNote r = micro.retune(note);
+            if (r.note != note || r.pitchBend != 8192) {
+                std::cerr << "12-EDO retune mismatch at " << note << "\n";
+                return 10;
+            }
+        }
+
+        micro.setTuning(Tuning::equalDivision(19));
+        for (int note = 0; note < 128; ++note) {
+            double cents12 = 1200.0 * std::log2(micro.getFrequency(note) / 440.0) - (note - 69) * 100.0;
+            RetunedNote r = micro.retune(note);
+            double bentCents = (r.note - 69) * 100.0 + (r.pitchBend - 8192) / 8192.0 * 4800.0;
+            if (std::fabs(cents12) > 1200.0 / 19 / 2 + 1e-6 ||
+                std::fabs(bentCents - 1200.0 * std::log2(micro.getFrequency(note) / 440.0)) > 1.0) {
+                std::cerr << "19-EDO quantize error at " << note << "\n";
+                return 10;
+            }
+        }
+
+        Tuning just;
+        const char* scl = "! just.scl\n!\nJust major\n 7\n!\n 9/8\n 5/4\n 4/3\n 3/2\n 5/3\n 15/8\n 1200.0\n";
+        if (!MicrotonalMapper::parseScala(scl, just) || just.size() != 7 ||
+            std::fabs(just.cents[3] - 701.955) > 0.001 || just.description != "Just major" ||
+            MicrotonalMapper::parseScala("bad\n3\n100.0\n", just)) {
+            std::cerr << "Scala parse failed\n";
+            return 11;
+        }
+
+        // White keys only, C = 261.6256 Hz, so A plays a just 5/3 above C
+        KeyboardMapping kbm;
+        const char* kbmText = "! white.kbm\n12\n0\n127\n60\n60\n261.6256\n7\n"
+                              "0\nx\n1\nx\n2\n3\nx\n4\nx\n5\nx\n6\n";
+        if (!MicrotonalMapper::parseKeyboardMapping(kbmText, kbm) || kbm.mapping[1] != -1) {
+            std::cerr << "Keyboard mapping parse failed\n";
+            return 11;
+        }
+        MicrotonalSettings ms;
+        ms.mode = MicrotonalMode::KeyboardMap;
+        micro.setSettings(ms);
+        micro.setTuning(just);
+        micro.setKeyboardMapping(kbm);
+        if (micro.retune(61).note != -1 || std::fabs(micro.getFrequency(69) - 261.6256 * 5 / 3) > 0.01 ||
+            std::fabs(micro.getFrequency(72) - 261.6256 * 2) > 0.01) {
+            std::cerr << "Keyboard map retune failed\n";
+            return 11;
+        }
+
+        // MPE: held notes get distinct member channels, note-off returns the same one
+        MicrotonalNote a = micro.noteOn(60);
+        MicrotonalNote b = micro.noteOn(64);
+        MicrotonalNote c = micro.noteOn(67);
+        if (a.channel < 2 || b.channel == a.channel || c.channel == a.channel || c.channel == b.channel ||
+            micro.noteOff(64).channel != b.channel || micro.noteOn(61).channel != -1) {
+            std::cerr << "MPE channel allocation failed\n";
+            return 12;
+        }
+
+        // Retrigger of a held key reports the note to turn off, then moves on
+        MicrotonalNote released;
+        MicrotonalNote retriggered = micro.noteOn(60, &released);
+        if (retriggered.channel < 2 || released.channel != a.channel || released.note != a.note ||
+            micro.noteOff(60).channel != retriggered.channel) {
+            std::cerr << "MPE retrigger lost the released note\n";
+            return 12;
+        }
+        micro.noteOn(64, &released);
+        if (released.channel != -1) {
+            std::cerr << "MPE fresh note reported a release\n";
+            return 12;
+        }
+    }
+
+    // Key tracking: follows a melody into E major, ignores one stray note,
+    // then moves to F major once the new key has clearly taken over
+    {
+        KeyTracker tracker;
+        const int eMajor[] = {64, 66, 68, 69, 71, 73, 75, 76, 71, 68, 64};
+        const int fMajor[] = {65, 67, 69, 70, 72, 74, 76, 77, 72, 69, 65};
+        int changes = 0;
+        for (int rep = 0; rep < 4; ++rep) {
+            for (int note : eMajor) changes += tracker.noteOn(note, 100) ? 1 : 0;
+        }
+        KeyEstimate key = tracker.getKey();
+        if (changes != 1 || key.rootNote != 4 || key.scale != ScaleType::Ionian) {
+            std::cerr << "KeyTracker did not settle on E major\n";
+            return 13;
+        }
+        if (tracker.noteOn(65, 100) || tracker.getKey().rootNote != 4) {
+            std::cerr << "KeyTracker changed key on a single stray note\n";
+            return 13;
+        }
+        for (int rep = 0; rep < 6; ++rep) {
+            for (int note : fMajor) tracker.noteOn(note, 100);
+        }
+        key = tracker.getKey();
+        if (key.rootNote != 5 || key.scale != ScaleType::Ionian) {
+            std::cerr << "KeyTracker did not follow the change to F major\n";
+            return 13;
+        }
+    }
+
+    // Note tracking: shared output notes are refcounted, the sustain pedal
+    // holds released notes until the next update, re-triggers replace
+    {
+        NoteTracker tracker;
+        tracker.trackNoteOn(60, std::vector<int>{60, 64, 67}, 100);
+        tracker.trackNoteOn(64, std::vector<int>{64, 67, 71}, 90);
+        if (tracker.getAllActiveGeneratedNotes() != std::vector<int>({60, 64, 67, 71}) ||
+            tracker.getOutputNoteRefCount(67) != 2) {
+            std::cerr << "NoteTracker output notes wrong\n";
+            return 14;
+        }
+        tracker.trackNoteOff(60);
+        if (tracker.getActiveOutputNotes().contains(60) || !tracker.getActiveOutputNotes().contains(67) ||
+            tracker.getActiveNoteCount() != 1) {
+            std::cerr << "NoteTracker note-off released shared notes\n";
+            return 14;
+        }
+        tracker.setSustainPedal(true);
+        tracker.trackNoteOff(64);
+        tracker.trackNoteOn(62, std::vector<int>{62, 65, 69}, 80);
+        tracker.trackNoteOn(62, std::vector<int>{62, 66, 69}, 80);
+        if (!tracker.isNotePlaying(64) || tracker.getActiveOutputNotes().contains(65)) {
+            std::cerr << "NoteTracker sustain/retrigger wrong\n";
+            return 14;
+        }
+        tracker.setSustainPedal(false);
+        tracker.updateEnvelopes(44100.0f);
+        std::vector<ActiveNote> active = tracker.getActiveNotes();
+        if (tracker.isNotePlaying(64) || active.size() != 1 || active[0].inputNote != 62 ||
+            tracker.getActiveOutputNotes().size() != 3) {
+            std::cerr << "NoteTracker sustain release wrong\n";
+            return 14;
+        }
+    }
+
+    // MIDI output stage: only the first note-on and the last note-off of a
+    // shared pitch go out, and same-sample off/on pairs cancel
+    {
+        MidiOutputStage stage;
+        std::vector<MidiNoteEvent> out;
+        auto drain = [&]() {
+            out.clear();
+            stage.drainEvents([&](const MidiNoteEvent& e) { out.push_back(e); });
+        };
+
+        stage.noteOn(0, 67, 100, 0);
+        stage.noteOn(0, 67, 90, 10);    // second holder, no event
+        stage.noteOn(1, 67, 90, 10);    // other channel is independent
+        drain();
+        if (out.size() != 2 || stage.getHolderCount(0, 67) != 2) {
+            std::cerr << "MidiOutputStage duplicate note-on emitted\n";
+            return 15;
+        }
+        if (stage.noteOff(0, 67, 20) || !stage.noteOff(0, 67, 30) || stage.noteOff(0, 67, 40)) {
+            std::cerr << "MidiOutputStage note-off not refcounted\n";
+            return 15;
+        }
+        drain();
+        if (out.size() != 1 || out[0].type != MidiNoteEvent::Type::NoteOff || out[0].samplePosition != 30) {
+            std::cerr << "MidiOutputStage emitted wrong note-offs\n";
+            return 15;
+        }
+
+        // Release and retrigger at the same sample: the note keeps sounding
+        stage.noteOff(1, 67, 50);
+        stage.noteOn(1, 67, 100, 50);
+        drain();
+        if (!out.empty() || !stage.isSounding(1, 67)) {
+            std::cerr << "MidiOutputStage did not merge same-sample off/on\n";
+            return 15;
+        }
+
+        // A stolen pitch's holders are swallowed on note-off
+        stage.noteOn(0, 60, 100, 0);
+        stage.noteOn(0, 60, 100, 0);
+        stage.forceNoteOff(0, 60, 5);
+        stage.noteOff(0, 60, 10);
+        stage.allNotesOff(20);
+        drain();
+        if (out.size() != 3 || out[1].note != 60 || out[2].note != 67 || out[2].channel != 1 ||
+            stage.isSounding(1, 67)) {
+            std::cerr << "MidiOutputStage force/all notes off wrong\n";
+            return 15;
+        }
+
+        // Steal, re-sound from another input, release the original holder:
+        // the new note keeps sounding until its own holder lets go
+        NoteTracker tracker;
+        tracker.trackNoteOn(60, std::vector<int>{60, 64}, 100);
+        stage.noteOn(0, 60, 100, 0);
+        stage.noteOn(0, 64, 100, 0);
+        stage.forceNoteOff(0, 64, 10);
+        tracker.removeOutputNote(64);
+        tracker.trackNoteOn(52, std::vector<int>{52, 64}, 100);
+        stage.noteOn(0, 52, 100, 20);
+        stage.noteOn(0, 64, 100, 20);
+        for (int note : *tracker.getGeneratedNotes(60)) stage.noteOff(0, note, 30);
+        tracker.trackNoteOff(60);
+        if (!stage.isSounding(0, 64) || stage.getHolderCount(0, 64) != 1 ||
+            tracker.getOutputNoteRefCount(64) != 1) {
+            std::cerr << "MidiOutputStage stale holder released a re-sounded pitch\n";
+            return 15;
+        }
+        for (int note : *tracker.getGeneratedNotes(52)) stage.noteOff(0, note, 40);
+        drain();
+        if (stage.isSounding(0, 64) || out.back().type != MidiNoteEvent::Type::NoteOff || out.back().note != 64) {
+            std::cerr << "MidiOutputStage re-sounded pitch not released by its holder\n";
+            return 15;
+        }
+
+        // Key re-pressed before its note-off (on/on/off), as processNoteOn()
+        // does it: the old chord's holds go before the new chord is tracked,
+        // so the one note-off leaves nothing sounding
+        auto press = [&](int key, const std::vector<int>& chord, int samplePosition) {
+            if (tracker.isNotePlaying(key)) {
+                for (int note : *tracker.getGeneratedNotes(key)) stage.noteOff(0, note, samplePosition);
+            }
+            tracker.trackNoteOn(key, chord, 100, samplePosition);
+            for (int note : chord) stage.noteOn(0, note, 100, samplePosition);
+        };
+        press(72, {72, 76, 79}, 50);
+        drain();
+        press(72, {72, 75, 79}, 60);
+        drain();
+        if (out.size() != 2 || out[0].type != MidiNoteEvent::Type::NoteOff || out[0].note != 76 ||
+            out[1].note != 75 || stage.getHolderCount(0, 72) != 1 || stage.getHolderCount(0, 79) != 1) {
+            std::cerr << "MidiOutputStage retrigger did not swap the chord\n";
+            return 15;
+        }
+        for (int note : *tracker.getGeneratedNotes(72)) stage.noteOff(0, note, 70);
+        tracker.trackNoteOff(72);
+        drain();
+        if (out.size() != 3 || stage.isSounding(0, 72) || stage.isSounding(0, 76) ||
+            stage.isSounding(0, 79) || tracker.getActiveOutputNotes().contains(72)) {
+            std::cerr << "MidiOutputStage retriggered key left notes stuck\n";
+            return 15;
+        }
+    }
+
+    // Event scheduler: events across level boundaries arrive at their exact
+    // sample in order, beat-scheduled events follow tempo, stop flushes offs
+    {
+        EventScheduler scheduler(256);
+        scheduler.prepare(48000.0, 120.0);
+        const int64_t times[] = {5, 5, 1023, 1024, 70000, 3000000, 2100000, 511};
+        for (int i = 0; i < 8; ++i) {
+            scheduler.scheduleAt(times[i], 0x90, static_cast<uint8_t>(60 + i), 100);
+        }
+        std::vector<int64_t> delivered;
+        std::vector<int> order;
+        while (scheduler.getCurrentTime() < 3100000) {
+            const int64_t blockStart = scheduler.getCurrentTime();
+            scheduler.processBlock(512, [&](const ScheduledMidiEvent& e, int offset) {
+                delivered.push_back(blockStart + offset);
+                order.push_back(e.data1 - 60);
+                if (e.time != blockStart + offset) delivered.push_back(-1);
+            });
+        }
+        if (delivered != std::vector<int64_t>({5, 5, 511, 1023, 1024, 70000, 2100000, 3000000}) ||
+            order != std::vector<int>({0, 1, 7, 2, 3, 4, 6, 5}) || scheduler.getPendingCount() != 0) {
+            std::cerr << "EventScheduler delivered events at the wrong time\n";
+            return 16;
+        }
+
+        // Halving the tempo doubles the remaining wait of beat-scheduled events only
+        const int64_t start = scheduler.getCurrentTime();
+        scheduler.scheduleAfterBeats(1.0, 0x80, 60, 0);   // 24000 samples at 120 bpm
+        scheduler.scheduleAfter(24000, 0x80, 61, 0);
+        scheduler.setTempo(60.0);
+        delivered.clear();
+        while (scheduler.getPendingCount() > 0 && scheduler.getCurrentTime() < start + 100000) {
+            const int64_t blockStart = scheduler.getCurrentTime();
+            scheduler.processBlock(256, [&](const ScheduledMidiEvent&, int offset) {
+                delivered.push_back(blockStart + offset - start);
+            });
+        }
+        if (delivered != std::vector<int64_t>({24000, 48000})) {
+            std::cerr << "EventScheduler tempo change not applied\n";
+            return 16;
+        }
+
+        scheduler.scheduleAfter(10, 0x90, 64, 100);
+        scheduler.scheduleAfter(20000, 0x80, 64, 0, 7);   // tagged, e.g. with its key press
+        int flushed = 0;
+        scheduler.flush([&](const ScheduledMidiEvent& e, int offset) {
+            flushed += (e.isNoteOff() && offset == 0 && e.tag == 7) ? 1 : 100;
+        });
+        if (flushed != 1 || scheduler.getPendingCount() != 0) {
+            std::cerr << "EventScheduler flush wrong\n";
+            return 16;
+        }
+    }
+
+    // Envelope bank: segments end exactly on their sample count, across block
+    // boundaries, independently per voice
+    {
+        EnvelopeSettings es;
+        es.attack = 10.0f;      // 10 samples at 1 kHz
+        es.decay = 20.0f;
+        es.sustain = 0.5f;
+        es.release = 10.0f;
+        es.velocitySensitivity = 0.0f;
+        EnvelopeBank bank(es);
+        bank.setSampleRate(1000.0f);
+        bank.noteOn(3, 127);
+
+        auto near = [](float a, float b) { return std::fabs(a - b) < 1e-5f; };
+        bank.process(5);
+        bool ok = near(bank.getLevel(3), 0.5f) && bank.getState(3) == EnvelopeState::Attack;
+        bank.process(10);
+        ok = ok && near(bank.getLevel(3), 0.875f) && bank.getState(3) == EnvelopeState::Decay;
+        bank.noteOn(0, 127);
+        bank.process(100);
+        ok = ok && near(bank.getLevel(3), 0.5f) && bank.getState(3) == EnvelopeState::Sustain &&
+             bank.getActiveCount() == 2;
+        bank.noteOff(3);
+        bank.process(5);
+        ok = ok && near(bank.getLevel(3), 0.25f) && bank.getState(3) == EnvelopeState::Release;
+        bank.process(10);
+        ok = ok && bank.isFinished(3) && bank.getLevel(3) == 0.0f &&
+             near(bank.getLevel(0), 0.5f) && bank.getActiveCount() == 1;
+        if (!ok) {
+            std::cerr << "EnvelopeBank segment timing wrong\n";
+            return 17;
+        }
+    }
+
+    // Exponential envelope: each segment ends on its sample count and is
+    // monotonic; humanization is one attack offset per note
+    {
+        EnvelopeSettings es;
+        es.attack = 10.0f;      // samples at 1 kHz
+        es.decay = 20.0f;
+        es.sustain = 0.5f;
+        es.release = 40.0f;
+        es.velocitySensitivity = 0.0f;
+        ExponentialEnvelope env(es);
+        env.noteOn(127, 1000.0f);
+
+        int attackSamples = 0, decaySamples = 0, releaseSamples = 0;
+        float previous = 0.0f;
+        bool monotonic = true;
+        while (env.getState() == EnvelopeState::Attack && attackSamples < 100) {
+            float level = env.process();
+            monotonic = monotonic && level >= previous;
+            previous = level;
+            ++attackSamples;
+        }
+        while (env.getState() == EnvelopeState::Decay && decaySamples < 100) {
+            float level = env.process();
+            monotonic = monotonic && level <= previous;
+            previous = level;
+            ++decaySamples;
+        }
+        bool sustained = env.getState() == EnvelopeState::Sustain && env.process() == 0.5f;
+        env.noteOff();
+        while (!env.isFinished() && releaseSamples < 200) {
+            env.process();
+            ++releaseSamples;
+        }
+        if (!monotonic || !sustained || std::abs(attackSamples - 10) > 1 ||
+            std::abs(decaySamples - 20) > 1 || std::abs(releaseSamples - 40) > 1) {
+            std::cerr << "ExponentialEnvelope segment lengths wrong: " << attackSamples << " "
+                      << decaySamples << " " << releaseSamples << "\n";
+            return 18;
+        }
+
+        es.humanize = true;
+        es.humanizeAmount = 0.2f;
+        env.setSettings(es);
+        env.noteOn(127, 1000.0f);
+        float offset = env.getHumanizeOffset();
+        env.process();
+        if (std::fabs(offset) > 0.2f || env.getHumanizeOffset() != offset) {
+            std::cerr << "ExponentialEnvelope humanize offset wrong\n";
+            return 18;
+        }
+    }
+
+    // Modulation output: big moves go out at once, small ones wait for the
+    // max interval, CC targets follow the loudest voice on the channel
+    {
+        ModulationSettings ms;
+        ms.target = ModulationTarget::PolyAftertouch;
+        ms.threshold = 4;
+        ms.minIntervalMs = 0.0f;
+        ms.maxIntervalMs = 50.0f;
+        ModulationOutput modulation;
+        modulation.setSampleRate(1000.0);   // 1-sample blocks = 1 ms
+        modulation.setSettings(ms);
+        modulation.startVoice(0, 60, 2);
+
+        std::array<float, ModulationOutput::MAX_VOICES> levels{};
+        int events = 0, lastValue = -1;
+        bool wrongMessage = false;
+        auto collect = [&](uint8_t status, uint8_t data1, uint8_t data2) {
+            ++events;
+            lastValue = data2;
+            wrongMessage = wrongMessage || status != 0xA2 || data1 != 60;
+        };
+        for (int step = 0; step <= 127; ++step) {   // one 7-bit step per block
+            levels[0] = step / 127.0f;
+            modulation.process(levels.data(), 1, collect);
+        }
+        bool ok = !wrongMessage && events == 32 && lastValue == 124;
+
+        levels[0] = 1.0f;   // 127: a 3-step change, sent only after 50 ms
+        int blocks = 0;
+        events = 0;
+        while (events == 0 && blocks < 200) {
+            modulation.process(levels.data(), 1, collect);
+            ++blocks;
+        }
+        ok = ok && lastValue == 127 && blocks == 47;   // 50 ms after the send at 124
+
+        ms.target = ModulationTarget::Expression;
+        modulation.setSettings(ms);
+        modulation.startVoice(1, 64, 2);
+        levels[0] = 0.25f;
+        levels[1] = 0.5f;
+        uint8_t ccStatus = 0, ccNumber = 0, ccValue = 0;
+        modulation.process(levels.data(), 1, [&](uint8_t status, uint8_t data1, uint8_t data2) {
+            ccStatus = status;
+            ccNumber = data1;
+            ccValue = data2;
+        });
+        ok = ok && ccStatus == 0xB2 && ccNumber == 11 && ccValue == 64;
+        if (!ok) {
+            std::cerr << "ModulationOutput thinning wrong\n";
+            return 19;
+        }
+    }
+
     std::cout << "All tests passed\n";
     return 0;
 }